@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "terraingen.hpp"
+#include "terraindata.hpp"
+#include "projector.hpp"
+#include "terrainprojected.hpp"
+#include "terrainstream.hpp"
+#include "terrainmosaic.hpp"
+#include "delaunay.hpp"
+#include "mesh2D.hpp"
+#include "grid.hpp"
+#include "trianglelocator.hpp"
+#include "trianglefilter.hpp"
+#include "rasterise.hpp"
+#include "ombrage.hpp"
+#include "ppm.hpp"
+#include "png.hpp"
+#include "profiler.hpp"
+
+// Micro-benchmarks par étape sur terrain synthétique :
+//   bench_mnt [--points=1M] [--layout=scattered|swath|gridded|all] [--width=2000]
+//             [--seed=42] [--repeat=3] [--stages=parse,project,...]
+// Débit en points/s (étapes sur les points) ou pixels/s (étapes sur l'image).
+
+static const char* ALL_STAGES[] = {
+    "parse", "project", "stream", "mosaic", "delaunay", "grid", "locate", "cull", "grid_cull", "locate_cull", "rasterize", "hillshade", "colour", "write", "write_png"
+};
+
+static std::string option(int argc, char** argv, const std::string& name, const std::string& defval)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string s = argv[i];
+        if (s.rfind(name + "=", 0) == 0) return s.substr(name.size() + 1);
+    }
+    return defval;
+}
+
+// "10K", "2.5M", "100M" -> nombre
+static std::size_t parse_count(const std::string& s)
+{
+    double v = std::atof(s.c_str());
+    if (!s.empty()) {
+        const char u = s.back();
+        if (u == 'k' || u == 'K') v *= 1e3;
+        if (u == 'm' || u == 'M') v *= 1e6;
+        if (u == 'g' || u == 'G') v *= 1e9;
+    }
+    return (std::size_t)std::llround(v);
+}
+
+static std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> out;
+    std::size_t a = 0;
+    while (a <= s.size()) {
+        const std::size_t b = std::min(s.find(',', a), s.size());
+        if (b > a) out.push_back(s.substr(a, b - a));
+        a = b + 1;
+    }
+    return out;
+}
+
+struct Bench {
+    std::string layout;
+    int repeat;
+    std::vector<std::string> stages;
+
+    bool enabled(const std::string& stage) const
+    {
+        return std::find(stages.begin(), stages.end(), stage) != stages.end();
+    }
+
+    // fn exécutée `repeat` fois ; meilleur temps et médiane, débit sur le meilleur
+    void run(const std::string& stage, std::size_t items, const char* unit, const std::function<void()>& fn) const
+    {
+        if (!enabled(stage)) return;
+
+        std::vector<double> ms;
+        for (int r = 0; r < repeat; ++r) {
+            const auto t0 = std::chrono::steady_clock::now();
+            fn();
+            const auto t1 = std::chrono::steady_clock::now();
+            ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        std::sort(ms.begin(), ms.end());
+
+        const double best = ms.front();
+        const double median = ms[ms.size() / 2];
+        const double rate = best > 0.0 ? (double)items / (best * 1e-3) : 0.0;
+
+        std::printf("%-10s %-10s %12zu %10.2f %10.2f %10.2f M%s/s\n",
+                    layout.c_str(), stage.c_str(), items, best, median, rate * 1e-6, unit);
+        std::fflush(stdout);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string s = argv[i];
+        if (s == "-h" || s == "--help") {
+            std::cout << "Utilisation : " << argv[0]
+                      << " [--points=N[K|M]] [--layout=scattered|swath|gridded|all] [--width=W]"
+                      << " [--seed=S] [--repeat=R] [--stages=liste]\n"
+                      << "Etapes : parse, project, stream, mosaic, delaunay, grid, locate, cull, grid_cull, locate_cull, rasterize, hillshade, colour, write, write_png\n";
+            return EXIT_SUCCESS;
+        }
+    }
+
+    const std::size_t npoints = parse_count(option(argc, argv, "--points", "1M"));
+    const std::size_t width = (std::size_t)std::atoll(option(argc, argv, "--width", "2000").c_str());
+    const std::uint64_t seed = (std::uint64_t)std::atoll(option(argc, argv, "--seed", "42").c_str());
+    const int repeat = std::max(1, std::atoi(option(argc, argv, "--repeat", "3").c_str()));
+
+    std::vector<std::string> stages = split(option(argc, argv, "--stages", ""));
+    if (stages.empty()) stages.assign(std::begin(ALL_STAGES), std::end(ALL_STAGES));
+
+    std::vector<std::string> layouts = split(option(argc, argv, "--layout", "all"));
+    if (layouts.size() == 1 && layouts[0] == "all") layouts = {"scattered", "swath", "gridded"};
+
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path() / "bench_mnt";
+    std::filesystem::create_directories(tmp);
+
+    std::printf("points=%zu width=%zu seed=%llu repeat=%d\n", npoints, width, (unsigned long long)seed, repeat);
+    std::printf("%-10s %-10s %12s %10s %10s %12s\n", "layout", "etape", "elements", "best_ms", "median_ms", "debit");
+
+    for (const auto& layout_name : layouts) {
+        TerrainGenerator::Params gp;
+        gp.points = npoints;
+        gp.layout = TerrainGenerator::parse_layout(layout_name);
+        gp.seed = seed;
+
+        Bench b{layout_name, repeat, stages};
+
+        // Génération et fichier d'entrée : hors mesure
+        const TerrainGenerator gen(gp);
+        const std::string input = (tmp / (layout_name + ".txt")).string();
+        const std::vector<GeoPoint> geo = gen.generate();
+        TerrainGenerator::write(input, geo);
+
+        // 2x2 tuiles recouvrantes (3 % de l'emprise) pour l'étape mosaic
+        std::vector<std::string> tiles;
+        if (b.enabled("mosaic")) {
+            double la0 = 1e300, la1 = -1e300, lo0 = 1e300, lo1 = -1e300;
+            for (const auto& g : geo) {
+                la0 = std::min(la0, g.lat); la1 = std::max(la1, g.lat);
+                lo0 = std::min(lo0, g.lon); lo1 = std::max(lo1, g.lon);
+            }
+            const double mla = 0.5 * (la0 + la1), mlo = 0.5 * (lo0 + lo1);
+            const double mla_m = 0.03 * (la1 - la0), mlo_m = 0.03 * (lo1 - lo0);
+            std::vector<GeoPoint> part[4];
+            for (const auto& g : geo) {
+                for (int t = 0; t < 4; ++t) {
+                    const bool in_lat = (t / 2 == 0) ? g.lat <= mla + mla_m : g.lat >= mla - mla_m;
+                    const bool in_lon = (t % 2 == 0) ? g.lon <= mlo + mlo_m : g.lon >= mlo - mlo_m;
+                    if (in_lat && in_lon) part[t].push_back(g);
+                }
+            }
+            for (int t = 0; t < 4; ++t) {
+                tiles.push_back((tmp / (layout_name + "_tuile" + std::to_string(t) + ".txt")).string());
+                TerrainGenerator::write(tiles.back(), part[t]);
+            }
+        }
+
+        // 1) Lecture
+        TerrainData terrain;
+        b.run("parse", npoints, "pts", [&] { terrain.load_data_from_file(input); });
+        if (!b.enabled("parse")) terrain.load_data_from_file(input);
+
+        // 2) Projection
+        Projector projector;
+        std::vector<Point3D> pts;
+        BBox2D bbox{0, 0, 0, 0};
+        auto project = [&] {
+            TerrainProjected proj(terrain, projector);
+            const auto& P = proj.points();
+            const auto& G = terrain.points();
+            pts.resize(P.size());
+            for (std::size_t i = 0; i < P.size(); ++i) pts[i] = {P[i].x, P[i].y, G[i].alt};
+            bbox = {proj.min_x(), proj.min_y(), proj.max_x(), proj.max_y()};
+        };
+        b.run("project", npoints, "pts", project);
+        if (!b.enabled("project")) project();
+
+        // 2b) Lecture + projection en flux (blocs recouverts sur le pool)
+        b.run("stream", npoints, "pts", [&] { TerrainStream::load(input, projector); });
+
+        // 2c) Mêmes points en 4 tuiles : chargement parallèle + raccords dédoublonnés
+        b.run("mosaic", npoints, "pts", [&] { TerrainMosaic::load(tiles, projector); });
+
+        // 3) Delaunay
+        std::vector<double> coords(pts.size() * 2), alts(pts.size());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            coords[2 * i] = pts[i].x;
+            coords[2 * i + 1] = pts[i].y;
+            alts[i] = pts[i].z;
+        }
+        std::vector<std::size_t> tris;
+        b.run("delaunay", npoints, "pts", [&] { tris = Delaunay::triangulate(coords); });
+        if (tris.empty()) tris = Delaunay::triangulate(coords);
+
+        const Mesh2D mesh(coords, tris, alts);
+
+        // 4) Index spatial (mêmes dimensions que create_raster)
+        b.run("grid", mesh.triangle_count(), "tri", [&] { Grid g(mesh, bbox, 1000, 1000); });
+        const TriangleLocator locator(mesh, Grid(mesh, bbox, 1000, 1000));
+
+        // 5) Localisation de requêtes uniformes dans la bbox
+        const std::size_t nq = std::max<std::size_t>(npoints, 100000);
+        std::vector<Point2D> queries(nq);
+        {
+            std::mt19937_64 rng(seed);
+            std::uniform_real_distribution<double> ux(bbox.minx, bbox.maxx), uy(bbox.miny, bbox.maxy);
+            for (auto& q : queries) q = {ux(rng), uy(rng)};
+        }
+        std::size_t hits = 0;
+        b.run("locate", nq, "pts", [&] {
+            hits = 0;
+            for (const auto& q : queries) hits += locator.locate(q.x, q.y).has_value();
+        });
+        if (b.enabled("locate")) {
+            std::printf("%-10s %-10s %11.1f%% dans l'enveloppe\n", layout_name.c_str(), "", 100.0 * (double)hits / (double)nq);
+#if MNT_PROFILING
+            // candidats examinés par requête (compteurs du profileur), index par
+            // cellules recoupées (défaut) et par bbox des triangles
+            const TriangleLocator bbox_locator(mesh, Grid(mesh, bbox, 1000, 1000, Grid::Overlap::BBox));
+            auto candidates = [&](const TriangleLocator& loc) {
+                const std::uint64_t c0 = Profiler::counter(Profiler::Counter::LocateCandidates);
+                Profiler::enable(true);
+                for (const auto& q : queries) loc.locate(q.x, q.y);
+                Profiler::enable(false);
+                return (double)(Profiler::counter(Profiler::Counter::LocateCandidates) - c0) / (double)nq;
+            };
+            const double exact = candidates(locator);
+            const double boxed = candidates(bbox_locator);
+            std::printf("%-10s %-10s %12.2f candidats/requete (bbox : %.2f)\n", layout_name.c_str(), "", exact, boxed);
+#endif
+        }
+
+        // 5b) Triangles à arête longue écartés (lacunes entre fauchées) : filtrage
+        // (copie du tableau comprise), puis index et localisation sur le maillage réduit
+        if (b.enabled("cull") || b.enabled("grid_cull") || b.enabled("locate_cull")) {
+            TriangleFilter::Params fp;
+            fp.edge_factor = 10.0;
+            std::vector<std::size_t> kept;
+            TriangleFilter::Stats fs;
+            b.run("cull", mesh.triangle_count(), "tri", [&] {
+                kept = tris;
+                fs = TriangleFilter::cull(coords, kept, fp);
+            });
+            if (kept.empty()) {
+                kept = tris;
+                fs = TriangleFilter::cull(coords, kept, fp);
+            }
+            std::printf("%-10s %-10s %12zu triangles ecartes (aretes > %.1f m)\n", layout_name.c_str(), "", fs.long_edge, fs.max_edge);
+
+            const Mesh2D culled(coords, kept, alts);
+            b.run("grid_cull", culled.triangle_count(), "tri", [&] { Grid g(culled, bbox, 1000, 1000); });
+            const TriangleLocator culled_locator(culled, Grid(culled, bbox, 1000, 1000));
+            b.run("locate_cull", nq, "pts", [&] {
+                hits = 0;
+                for (const auto& q : queries) hits += culled_locator.locate(q.x, q.y).has_value();
+            });
+            if (b.enabled("locate_cull")) std::printf("%-10s %-10s %11.1f%% dans le maillage filtre\n", layout_name.c_str(), "", 100.0 * (double)hits / (double)nq);
+        }
+
+        // 6) Rasterisation, ombrage, couleur, écriture
+        const Rasterizer rast(locator, bbox, terrain.min_alt(), terrain.max_alt());
+        const std::size_t npx = width * Rasterizer::output_height(bbox, width);
+        ZRaster zr;
+        b.run("rasterize", npx, "px", [&] { zr = rast.rasterize_z(width); });
+        if (zr.z.empty()) zr = rast.rasterize_z(width);
+
+        b.run("hillshade", npx, "px", [&] { Ombrage::compute(zr.z, zr.width, zr.height, zr.dx, zr.dy, 315.0, 45.0); });
+
+        Rasterizer::Params rp;
+        rp.ombrage = false; // couleur seule : l'ombrage est mesuré à part
+        std::vector<std::uint8_t> img;
+        b.run("colour", npx, "px", [&] { img = rast.colorize(zr, rp); });
+        if (img.empty()) img = rast.colorize(zr, rp);
+
+        const std::string out = (tmp / (layout_name + ".ppm")).string();
+        b.run("write", npx, "px", [&] { PPM::write_p6(out, zr.width, zr.height, img); });
+        const std::string out_png = (tmp / (layout_name + ".png")).string();
+        b.run("write_png", npx, "px", [&] { PngWriter::write(out_png, zr.width, zr.height, img); });
+
+        std::filesystem::remove(input);
+        for (const auto& t : tiles) std::filesystem::remove(t);
+    }
+
+    return EXIT_SUCCESS;
+}
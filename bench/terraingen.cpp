@@ -0,0 +1,177 @@
+#include "terraingen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "parallel.hpp"
+
+static inline std::uint64_t mix(std::uint64_t x)
+{
+    // splitmix64
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static inline double unit(std::uint64_t h)
+{
+    return (double)(h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline double hash01(std::uint64_t seed, std::uint64_t a, std::uint64_t b)
+{
+    return unit(mix(seed ^ mix(a ^ mix(b))));
+}
+
+TerrainGenerator::TerrainGenerator(const Params& p) : m_p(p)
+{
+    if (p.points == 0) throw std::runtime_error("TerrainGenerator: nombre de points nul.");
+    if (p.extent_deg <= 0.0) throw std::runtime_error("TerrainGenerator: emprise invalide.");
+
+    const double n = (double)p.points;
+
+    m_cols = std::max<std::size_t>(1, (std::size_t)std::ceil(std::sqrt(n)));
+    m_rows = (p.points + m_cols - 1) / m_cols;
+
+    // fauchées parallèles est-ouest ; faisceaux en travers, pings le long
+    m_lines = std::max<std::size_t>(1, (std::size_t)std::llround(std::sqrt(n) / 64.0));
+    m_per_line = (p.points + m_lines - 1) / m_lines;
+    m_beams = std::clamp<std::size_t>((std::size_t)std::llround(std::sqrt((double)m_per_line / 8.0)), 8, 512);
+    m_pings = std::max<std::size_t>(1, (m_per_line + m_beams - 1) / m_beams);
+}
+
+TerrainGenerator::Layout TerrainGenerator::parse_layout(const std::string& name)
+{
+    if (name == "scattered") return Layout::Scattered;
+    if (name == "swath") return Layout::Swath;
+    if (name == "gridded") return Layout::Gridded;
+    throw std::runtime_error("TerrainGenerator: disposition inconnue : " + name);
+}
+
+const char* TerrainGenerator::layout_name(Layout l)
+{
+    switch (l) {
+        case Layout::Swath: return "swath";
+        case Layout::Gridded: return "gridded";
+        default: return "scattered";
+    }
+}
+
+double TerrainGenerator::value_noise(double x, double y, std::uint64_t octave) const
+{
+    const double fx = std::floor(x), fy = std::floor(y);
+    const std::int64_t ix = (std::int64_t)fx, iy = (std::int64_t)fy;
+    double tx = x - fx, ty = y - fy;
+
+    // interpolation quintique : dérivées continues (ombrage sans facettes)
+    tx = tx * tx * tx * (tx * (tx * 6.0 - 15.0) + 10.0);
+    ty = ty * ty * ty * (ty * (ty * 6.0 - 15.0) + 10.0);
+
+    const std::uint64_t s = m_p.seed ^ mix(octave);
+    auto lattice = [&](std::int64_t a, std::int64_t b) {
+        return 2.0 * hash01(s, (std::uint64_t)a, (std::uint64_t)b) - 1.0;
+    };
+
+    const double v00 = lattice(ix, iy), v10 = lattice(ix + 1, iy);
+    const double v01 = lattice(ix, iy + 1), v11 = lattice(ix + 1, iy + 1);
+    const double a = v00 + (v10 - v00) * tx;
+    const double b = v01 + (v11 - v01) * tx;
+    return a + (b - a) * ty;
+}
+
+double TerrainGenerator::altitude(double u, double v) const
+{
+    double sum = 0.0, amp = 1.0, norm = 0.0, freq = 4.0;
+    for (int o = 0; o < m_p.octaves; ++o) {
+        sum += amp * value_noise(u * freq, v * freq, (std::uint64_t)o);
+        norm += amp;
+        amp *= m_p.gain;
+        freq *= 2.0;
+    }
+    // légère pente régionale : une partie du relief passe sous le niveau 0
+    return m_p.relief_m * (sum / norm) + 0.25 * m_p.relief_m * (u - 0.5);
+}
+
+void TerrainGenerator::position(std::size_t i, double& u, double& v) const
+{
+    switch (m_p.layout) {
+        case Layout::Gridded:
+            u = ((double)(i % m_cols) + 0.5) / (double)m_cols;
+            v = ((double)(i / m_cols) + 0.5) / (double)m_rows;
+            return;
+
+        case Layout::Swath: {
+            const std::size_t line = std::min(i / m_per_line, m_lines - 1);
+            const std::size_t k = i - line * m_per_line;
+            const std::size_t ping = k / m_beams;
+            const std::size_t beam = k % m_beams;
+
+            // trajectoire ondulée, fauchée 20 % plus large que l'interligne
+            const double spacing = 1.0 / (double)m_lines;
+            const double along = ((double)ping + hash01(m_p.seed, i, 7)) / (double)m_pings;
+            const double centre = ((double)line + 0.5) * spacing + 0.15 * spacing * std::sin(6.283185307179586 * (2.0 * along + 0.37 * (double)line));
+            const double across = m_beams > 1 ? 2.0 * (double)beam / (double)(m_beams - 1) - 1.0 : 0.0;
+            const double jitter = 0.01 * spacing * (2.0 * hash01(m_p.seed, i, 8) - 1.0);
+
+            u = std::clamp(along, 0.0, 1.0);
+            v = std::clamp(centre + 0.6 * spacing * across + jitter, 0.0, 1.0);
+            return;
+        }
+
+        default:
+            u = hash01(m_p.seed, i, 0);
+            v = hash01(m_p.seed, i, 1);
+            return;
+    }
+}
+
+std::vector<GeoPoint> TerrainGenerator::generate() const
+{
+    std::vector<GeoPoint> pts(m_p.points);
+    const double deg2rad = 3.14159265358979323846 / 180.0;
+    const double lon_extent = m_p.extent_deg / std::cos(m_p.lat0 * deg2rad);
+
+    parallel_for(0, pts.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            double u, v;
+            position(i, u, v);
+            pts[i] = GeoPoint(m_p.lat0 + (v - 0.5) * m_p.extent_deg,
+                              m_p.lon0 + (u - 0.5) * lon_extent,
+                              altitude(u, v));
+        }
+    }, 4096);
+
+    return pts;
+}
+
+void TerrainGenerator::write(const std::string& path, const std::vector<GeoPoint>& pts)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) throw std::runtime_error("TerrainGenerator: impossible d'ouvrir " + path);
+
+    // formatage en parallèle par blocs, écriture dans l'ordre
+    const std::size_t block = 1 << 18;
+    for (std::size_t b0 = 0; b0 < pts.size(); b0 += block * worker_count()) {
+        const std::size_t nb = std::min(worker_count(), (pts.size() - b0 + block - 1) / block);
+        std::vector<std::string> text(nb);
+
+        parallel_for(0, nb, [&](std::size_t k0, std::size_t k1) {
+            char line[96];
+            for (std::size_t k = k0; k < k1; ++k) {
+                const std::size_t lo = b0 + k * block;
+                const std::size_t hi = std::min(pts.size(), lo + block);
+                std::string& s = text[k];
+                s.reserve((hi - lo) * 32);
+                for (std::size_t i = lo; i < hi; ++i) {
+                    const int n = std::snprintf(line, sizeof(line), "%.8f %.8f %.3f\n", pts[i].lat, pts[i].lon, pts[i].alt);
+                    s.append(line, (std::size_t)n);
+                }
+            }
+        });
+
+        for (const auto& s : text) ofs.write(s.data(), (std::streamsize)s.size());
+    }
+    if (!ofs) throw std::runtime_error("TerrainGenerator: erreur d'écriture de " + path);
+}
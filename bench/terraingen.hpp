@@ -0,0 +1,59 @@
+#ifndef TERRAINGEN_HPP
+#define TERRAINGEN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "geopoint.hpp"
+
+// Générateur de MNT synthétique reproductible : relief fractal (fBm de bruit
+// de valeur, graine fixe) échantillonné selon trois dispositions de levé.
+// Chaque point ne dépend que de (graine, indice) : le résultat est identique
+// quel que soit le nombre de threads.
+class TerrainGenerator {
+public:
+    enum class Layout {
+        Scattered, // positions uniformes aléatoires
+        Swath,     // fauchées de sondeur multifaisceaux (pings x faisceaux)
+        Gridded    // grille régulière
+    };
+
+    struct Params {
+        std::size_t points;
+        Layout layout;
+        std::uint64_t seed;
+        double lat0, lon0;     // centre de la zone (degrés)
+        double extent_deg;     // côté de la zone en latitude
+        double relief_m;       // amplitude verticale
+        int octaves;
+        double gain;           // atténuation par octave (rugosité)
+
+        Params(): points(100000), layout(Layout::Scattered), seed(42), lat0(48.35), lon0(-4.5), extent_deg(0.1), relief_m(120.0), octaves(8), gain(0.5){}
+    };
+
+    explicit TerrainGenerator(const Params& p);
+
+    // Altitude en (u, v) dans [0,1]^2 (u vers l'est, v vers le nord)
+    double altitude(double u, double v) const;
+
+    std::vector<GeoPoint> generate() const;
+
+    // Fichier texte "lat lon alt" lisible par TerrainData
+    static void write(const std::string& path, const std::vector<GeoPoint>& pts);
+
+    static Layout parse_layout(const std::string& name);
+    static const char* layout_name(Layout l);
+
+private:
+    void position(std::size_t i, double& u, double& v) const;
+    double value_noise(double x, double y, std::uint64_t octave) const;
+
+    Params m_p;
+    // découpage des fauchées
+    std::size_t m_lines = 1, m_beams = 1, m_pings = 1, m_per_line = 1;
+    // découpage de la grille
+    std::size_t m_cols = 1, m_rows = 1;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef BINNING_HPP
+#define BINNING_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "geopoint.hpp"
+#include "mesh2D.hpp"
+
+// Agrégation parallèle de points dans une grille régulière gw x gh couvrant bb
+// (ligne 0 = maxy, points hors [min, max[ ignorés).
+// Petites grilles : une grille partielle par thread, fusionnées à la fin.
+// Grandes grilles ou médiane : points pré-répartis par bandes de lignes,
+// chaque thread agrège ses bandes sans conflit d'écriture.
+class PointBinner {
+public:
+    // Statistiques par cellule (combinables)
+    enum Stat : unsigned {
+        MEAN   = 1u << 0,
+        MIN    = 1u << 1,
+        MAX    = 1u << 2,
+        MEDIAN = 1u << 3
+    };
+
+    struct Result {
+        std::size_t gw = 0, gh = 0;
+        std::vector<std::uint32_t> count;              // toujours rempli
+        std::vector<double> mean, min, max, median;    // remplis selon stats (0 si vide)
+    };
+
+    static Result bin(const std::vector<Point3D>& pts, const BBox2D& bb, std::size_t gw, std::size_t gh, unsigned stats = MEAN);
+
+    // Cellule d'un point, ou NO_CELL s'il est hors grille
+    static constexpr std::uint64_t NO_CELL = ~std::uint64_t(0);
+
+private:
+    static void bin_private_grids(const std::vector<Point3D>& pts, const BBox2D& bb, unsigned stats, Result& r);
+    static void bin_partitioned(const std::vector<Point3D>& pts, const BBox2D& bb, unsigned stats, Result& r);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef COLORKERNEL_HPP
+#define COLORKERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Bloc de lignes à coloriser (pointeurs sur la grille complète)
+struct ColorRows {
+    const double* z;
+    const std::uint8_t* mask;
+    const double* shade;       // nullptr sans ombrage
+    const std::uint32_t* base; // remap[zq] * HaxbyColorMap::SHADE_LEVELS
+    const std::uint8_t* lut;   // HaxbyColorMap::shaded_lut()
+    std::size_t width;
+    double zmin;
+    double zscale;             // (Z_LEVELS - 1) / (zmax - zmin)
+    std::uint8_t* out;         // 3 ou 4 canaux par pixel
+};
+
+// Noyaux de colorisation de Rasterizer::colorize, instanciés à la compilation
+// pour chaque combinaison ombrage / masque / précision / canaux : une option
+// absente n'existe pas dans le code généré. select() choisit l'instanciation
+// une fois par rendu, en version AVX2 si le processeur la supporte (même
+// résultat, à l'octet près, que la version générique).
+class ColorKernels {
+public:
+    using Kernel = void (*)(const ColorRows& rows, std::size_t j0, std::size_t j1);
+
+    static Kernel select(bool shaded, bool masked, bool single_precision, std::size_t channels);
+
+    // Jeu d'instructions retenu ("avx2" ou "generique") ; MNT_NO_AVX2 force "generique"
+    static const char* isa();
+};
+
+#endif
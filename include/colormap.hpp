@@ -1,7 +1,6 @@
 #ifndef COLORMAP_HPP
 #define COLORMAP_HPP
 
-#include <array>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -14,12 +13,22 @@ struct RGB {
         
     public:
 
+        // LUT ombrée : altitude quantifiée x facteur d'ombrage quantifié -> RGB
+        static constexpr std::uint32_t Z_LEVELS = 4096;
+        static constexpr std::uint32_t SHADE_LEVELS = 256;
+        // Entrée supplémentaire en fin de table (noir) pour les pixels invalides
+        static constexpr std::uint32_t INVALID_INDEX = Z_LEVELS * SHADE_LEVELS;
+
         void load_cpt(const std::string& filepath);   // resources/haxby.cpt
 
         RGB color(double z, double zmin, double zmax) const;
 
         static RGB shade(RGB c, double s);
 
+        // Table (Z_LEVELS * SHADE_LEVELS + 1) * 3 octets, entrée = zq * SHADE_LEVELS + sq
+        const std::uint8_t* shaded_lut() const { return m_shaded.data(); }
+        bool ready() const { return m_ready; }
+
     private:
 
         struct Segment {
@@ -28,10 +37,12 @@ struct RGB {
         };
 
         std::vector<Segment> m_segments;
-        std::array<RGB,256> m_lut{};
+        std::vector<RGB> m_lut;               // Z_LEVELS couleurs
+        std::vector<std::uint8_t> m_shaded;   // LUT 2D ombrée
         bool m_ready = false;
 
-        void build_lut_256();
+        void build_lut();
+        void build_shaded_lut();
     };
 
 #endif
\ No newline at end of file
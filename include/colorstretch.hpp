@@ -0,0 +1,43 @@
+#ifndef COLORSTRETCH_HPP
+#define COLORSTRETCH_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Étirement automatique de la palette à partir de l'histogramme des altitudes
+// rendues. Le résultat donne la plage [zmin, zmax] sur laquelle le noyau de
+// couleur quantifie les altitudes (Z_LEVELS niveaux, valeurs hors plage
+// écrêtées) et une table de HaxbyColorMap::Z_LEVELS entrées :
+// niveau quantifié -> ligne de la LUT ombrée.
+class ColorStretch {
+public:
+    enum class Mode {
+        Linear,     // identité (comportement historique)
+        Percentile, // écrêtage des clip_pct % extrêmes de chaque côté
+        Equalize    // égalisation d'histogramme
+    };
+
+    struct Result {
+        double zmin;                       // plage de quantification du noyau
+        double zmax;
+        std::vector<std::uint16_t> remap;  // niveau quantifié -> ligne de la LUT
+    };
+
+    static Result compute(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, double zmin, double zmax, Mode mode, double clip_pct = 1.0);
+
+    static std::vector<std::uint16_t> identity();
+
+private:
+    // Classes de l'histogramme fin servant à placer les rangs d'écrêtage
+    static constexpr std::size_t FINE_LEVELS = 1 << 16;
+
+    // Histogramme sur `levels` classes entre zmin et zmax (valeurs hors plage
+    // dans les classes extrêmes), un histogramme partiel par thread
+    static std::vector<std::uint64_t> histogram(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, double zmin, double zmax, std::size_t levels);
+
+    // Altitudes des rangs lo_count et hi_count, interpolées dans leur classe
+    static void rank_range(const std::vector<std::uint64_t>& hist, double zmin, double zmax, std::uint64_t lo_count, std::uint64_t hi_count, double& z_lo, double& z_hi);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef CONVOLUTION_HPP
+#define CONVOLUTION_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Convolution séparable float32 réutilisable par les étapes de lissage.
+// Bords répliqués, traités hors de la boucle interne ; passe verticale
+// par blocs de colonnes (accès contigus) ; lignes réparties sur les threads.
+class Convolution {
+public:
+    // Noyau gaussien normalisé de rayon ceil(3 sigma) (au moins 1)
+    static std::vector<float> gaussian_kernel(double sigma);
+
+    // Convolution en place de img (w x h, ligne par ligne) par kernel (taille impaire)
+    static void separable(std::vector<float>& img, std::size_t w, std::size_t h, const std::vector<float>& kernel);
+
+private:
+    static void horizontal_row(const float* in, float* out, std::size_t w, const float* k, std::size_t r);
+    static void vertical_rows(const float* in, float* out, std::size_t w, std::size_t h, std::size_t y0, std::size_t y1, const float* k, std::size_t r);
+};
+
+#endif
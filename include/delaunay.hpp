@@ -0,0 +1,20 @@
+#ifndef DELAUNAY_HPP
+#define DELAUNAY_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Point d'entrée unique vers delaunator.hpp, dont les fonctions membres ne
+// sont pas inline : une seule unité de compilation peut l'inclure.
+class Delaunay {
+public:
+    // coords = {x0,y0,x1,y1,...} ; renvoie les indices de sommets par triangle.
+    // Lève std::runtime_error si les points sont alignés ou trop peu nombreux.
+    // halfedges (optionnel) : demi-arête opposée à chaque demi-arête 3t+k
+    // (de triangles[3t+k] vers le sommet suivant du triangle), NO_EDGE sur l'enveloppe.
+    static std::vector<std::size_t> triangulate(const std::vector<double>& coords, std::vector<std::size_t>* halfedges = nullptr);
+
+    static constexpr std::size_t NO_EDGE = static_cast<std::size_t>(-1);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// FFT 2D réelle radix-2 (dimensions puissances de 2), twiddles précalculés.
+// Le spectre est stocké en demi-plan : h lignes x (w/2 + 1) colonnes.
+// Lignes et colonnes sont transformées en parallèle.
+class FFT2D {
+public:
+    using cplx = std::complex<double>;
+
+    FFT2D(std::size_t w, std::size_t h);
+
+    std::size_t width() const { return m_w; }
+    std::size_t height() const { return m_h; }
+    std::size_t spec_width() const { return m_w / 2 + 1; }
+
+    void forward(const std::vector<double>& in, std::vector<cplx>& spec) const;
+    // Modifie spec (utilisé comme tampon de travail)
+    void inverse(std::vector<cplx>& spec, std::vector<double>& out) const;
+
+    static bool is_pow2(std::size_t v);
+
+private:
+    // Table pour une FFT complexe de longueur n
+    struct Plan {
+        std::size_t n = 0;
+        std::vector<cplx> tw;          // exp(-2iπk/n), k < n/2
+        std::vector<std::size_t> rev;  // permutation bit-reverse
+    };
+
+    static Plan make_plan(std::size_t n);
+    static void fft1d(cplx* a, const Plan& p, bool inverse);
+
+    // Ligne réelle de longueur w <-> w/2+1 coefficients (via une FFT complexe de w/2)
+    void row_forward(const double* in, cplx* out, cplx* work) const;
+    void row_inverse(const cplx* in, double* out, cplx* work) const;
+
+    std::size_t m_w;
+    std::size_t m_h;
+    Plan m_row;                 // longueur w/2
+    Plan m_col;                 // longueur h
+    std::vector<cplx> m_split;  // exp(-2iπk/w), k <= w/2
+};
+
+#endif
@@ -5,21 +5,44 @@
 #include <cstddef>
 #include <cstdint>
 #include "mesh2D.hpp"
-
-struct Point3D {
-    double x, y, z;
+#include "binning.hpp"
+
+// Grille filtrée (ligne 0 = maxy), masque aux valeurs FourierPreprocess::CELL_*
+struct FilteredGrid {
+    std::size_t gw = 0, gh = 0;
+    BBox2D bbox{0.0, 0.0, 0.0, 0.0};
+    std::vector<double> z;
+    std::vector<std::uint8_t> mask;
 };
 
 class FourierPreprocess {
     public:
+        enum class Filter { Gaussian, Butterworth };
+        enum class Domain { Auto, Spatial, Frequency };
+        enum class Sampling { Regular, Adaptive };
+
+        // Valeurs du masque de grille
+        static constexpr std::uint8_t CELL_EMPTY    = 0;
+        static constexpr std::uint8_t CELL_MEASURED = 1;
+        static constexpr std::uint8_t CELL_FILLED   = 2; // synthétisée par fill_missing
+
         struct Params {
             double grid_scale;
-            int fill_iters;
+            int fill_iters;            // rayon de remplissage (cellules) ; 0 = aucun, < 0 = illimité
             double sigma_px;
             std::size_t sample_step;
             bool pow2_grid;
-
-            Params(): grid_scale(1.0), fill_iters(4), sigma_px(2.0), sample_step(2), pow2_grid(true){}
+            Filter filter;             // Butterworth : domaine fréquentiel uniquement
+            Domain domain;             // Auto : choix selon sigma et taille de grille
+            double cutoff;             // fréquence de coupure Butterworth (cycles/cellule, <= 0.5)
+            int butterworth_order;
+            bool keep_filled;          // false : pas de points Delaunay sur les cellules synthétisées
+            Sampling sampling;         // Adaptive : points denses seulement là où le terrain l'exige
+            double max_error;          // tolérance verticale (unités de z) du mode Adaptive
+            std::size_t point_budget;  // > 0 : nombre de points visé (prioritaire sur max_error)
+            int adaptive_levels;       // squelette régulier au pas sample_step * 2^levels
+
+            Params(): grid_scale(1.0), fill_iters(4), sigma_px(2.0), sample_step(2), pow2_grid(true), filter(Filter::Gaussian), domain(Domain::Auto), cutoff(0.1), butterworth_order(2), keep_filled(true), sampling(Sampling::Regular), max_error(0.5), point_budget(0), adaptive_levels(4){}
         };
 
         explicit FourierPreprocess(Params p = Params());
@@ -28,10 +51,16 @@ class FourierPreprocess {
         // Sortie: points (x,y,z) filtrés + sous-échantillonnés (moins nombreux) pour Delaunay
         std::vector<Point3D> run(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t target_width_px) const;
 
+        // Mêmes étapes sans l'échantillonnage : grille filtrée à rééchantillonner
+        // directement sur les pixels (GridResampler), sans Delaunay
+        FilteredGrid run_grid(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t target_width_px) const;
+
         // Juste info/debug (par chatgpt): dimensions de grille utilisées
         struct GridInfo {
             std::size_t gw = 0, gh = 0;
             double dx = 0.0, dy = 0.0;
+            bool frequency_domain = false; // filtrage effectué par FFT
+            std::size_t filled = 0;        // cellules synthétisées par fill_missing
         };
 
         GridInfo last_grid() const { return m_last; }
@@ -47,11 +76,32 @@ class FourierPreprocess {
 
         static void bin_average(const std::vector<Point3D>& pts, const BBox2D& bb, std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask);
 
-        static void fill_missing(std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask, int iters);
+        // Remplissage push-pull (pyramide) en O(n) : les trous de toute taille sont comblés
+        // jusqu'à max_dist cellules (distance de Tchebychev) des cellules mesurées.
+        // Les cellules remplies passent à CELL_FILLED ; retourne leur nombre.
+        static std::size_t fill_missing(std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask, int max_dist);
+
+        // Distance de Tchebychev (en cellules) à la plus proche cellule mesurée, 2 passes
+        static std::vector<std::uint32_t> distance_to_measured(std::size_t gw, std::size_t gh, const std::vector<std::uint8_t>& mask);
 
         static void gaussian_separable(std::size_t gw, std::size_t gh, std::vector<double>& z, double sigma_px);
 
-        static std::vector<Point3D> sample_regular(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t step);
+        // Filtrage passe-bas dans le domaine fréquentiel (FFT2D sur la grille bordée
+        // de fft_padding cellules répliquées, portée à une puissance de 2, puis recadrée)
+        static void lowpass_fft(std::size_t gw, std::size_t gh, std::vector<double>& z, const Params& p);
+
+        // Bordure (cellules) couvrant la portée du noyau
+        static std::size_t fft_padding(const Params& p);
+
+        // Vrai si le filtrage fréquentiel est moins coûteux (ou imposé)
+        static bool use_frequency_domain(std::size_t gw, std::size_t gh, const Params& p);
+
+        // Échantillonnage hiérarchique : une cellule du niveau L (pas sample_step * 2^L)
+        // est conservée si elle s'écarte de plus de max_error de l'interpolation
+        // linéaire de ses voisines du niveau plus grossier.
+        static std::vector<Point3D> sample_adaptive(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, const Params& p);
+
+        static std::vector<Point3D> sample_regular(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t step, bool keep_filled);
     };
 
 #endif
\ No newline at end of file
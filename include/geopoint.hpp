@@ -13,6 +13,11 @@ struct GeoPoint {
 
 };
 
+// Point projeté (x, y en mètres) avec altitude
+struct Point3D {
+    double x, y, z;
+};
+
 inline std::ostream& operator<<(std::ostream& os, const GeoPoint& p){
     os << p.lat << " " << p.lon << " " << p.alt;
     return os;
@@ -7,7 +7,11 @@
 
 class Grid {
     public:
-        Grid(const Mesh2D& mesh, BBox2D bbox, std::size_t nx, std::size_t ny);
+        // Cellules associées à un triangle : celles de sa bbox, ou seulement
+        // celles qu'il recoupe réellement (triangles longs et obliques)
+        enum class Overlap { BBox, Exact };
+
+        Grid(const Mesh2D& mesh, BBox2D bbox, std::size_t nx, std::size_t ny, Overlap overlap = Overlap::Exact);
 
         // Liste de triangles candidats pour un point p
         const std::vector<std::size_t>& candidates(double x, double y) const;
@@ -16,12 +20,22 @@ class Grid {
         std::size_t nx() const;
         std::size_t ny() const;
 
+        // Mise à jour locale après modification du maillage. insert() ajoute
+        // le triangle aux mêmes cellules qu'à la construction : celles qu'il
+        // recoupe (Overlap::Exact) ou toute sa bbox (Overlap::BBox). remove()
+        // parcourt toujours les cellules de la bbox qu'avait le triangle à son
+        // insertion, qui contiennent celles où il a été ajouté.
+        void insert(std::size_t ti);
+        void remove(std::size_t ti, const BBox2D& tb);
+
     private:
 
         std::size_t cell_index(std::size_t ix, std::size_t iy) const;
         std::size_t clamp_index(long v, std::size_t maxv) const;
 
         std::pair<std::size_t,std::size_t> cell_of(double x, double y) const;
+        void cell_range(const BBox2D& tb, std::size_t& cx0, std::size_t& cx1, std::size_t& cy0, std::size_t& cy1) const;
+        void init_steps();
     
     private:
 
@@ -29,6 +43,7 @@ class Grid {
         BBox2D m_bbox;
         std::size_t m_nx;
         std::size_t m_ny;
+        Overlap m_overlap = Overlap::Exact;
         double m_dx;
         double m_dy;
 
@@ -0,0 +1,114 @@
+#ifndef INCREMENTALTIN_HPP
+#define INCREMENTALTIN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "geopoint.hpp"
+#include "mesh2D.hpp"
+#include "rasterise.hpp"
+#include "trianglelocator.hpp"
+
+// TIN modifiable pour le rendu incrémental (levé complété en cours de
+// campagne) : maillage de Delaunay avec ses demi-arêtes et grille z de la
+// dernière image, sauvegardés dans un fichier d'état ; l'index Grid, dimensionné
+// sur le nombre de triangles, est reconstruit à la relecture. Les points ajoutés
+// sont insérés un à un (Bowyer-Watson : cavité des triangles dont le cercle
+// circonscrit contient le point, retriangulée en éventail autour de lui,
+// enveloppe convexe étendue si besoin) ; l'index n'est mis à jour que pour
+// les triangles retirés ou créés, et seuls les pixels couverts par un triangle
+// créé sont réinterpolés.
+class IncrementalTin {
+public:
+    // Fichier source et paramètres de rendu de l'état
+    struct Source {
+        std::string key;            // paramètres de rendu (largeur, options)
+        std::string path;           // fichier MNT
+        std::uint64_t bytes = 0;    // octets déjà lus
+        std::uint64_t lines = 0;    // lignes déjà lues
+        std::uint32_t crc = 0;      // CRC-32 des octets déjà lus
+    };
+
+    // Rectangle de pixels [x0, x1) x [y0, y1) ; vide si x0 >= x1
+    struct PixelRect {
+        std::size_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+    };
+
+    struct Stats {
+        std::size_t inserted = 0;
+        std::size_t duplicates = 0;     // points confondus avec un sommet existant
+        std::size_t removed = 0;        // triangles retirés (cavités)
+        std::size_t created = 0;        // triangles créés
+    };
+
+    // Construction complète : Delaunay, index Grid, grille z de width pixels sur bbox
+    IncrementalTin(const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, std::size_t width);
+
+    // État relu ; nullptr si le fichier est absent ou d'une autre version
+    static std::unique_ptr<IncrementalTin> load(const std::string& path);
+    void save(const std::string& path) const;
+
+    // CRC-32 des bytes premiers octets de path (contrôle de l'ajout en fin de fichier) ;
+    // last_newline : le dernier de ces octets est un saut de ligne
+    static std::uint32_t fingerprint(const std::string& path, std::uint64_t bytes, bool* last_newline = nullptr);
+
+    // Insère les points (dans l'ordre) ; false dès qu'une cavité est dégénérée
+    // (maillage laissé valide, points restants non insérés : reconstruire)
+    bool insert(const std::vector<Point3D>& pts, Stats& stats);
+
+    // Réinterpole la grille z sur les triangles créés depuis le dernier appel ;
+    // renvoie le rectangle des pixels modifiés
+    PixelRect update_raster();
+
+    Source& source() { return m_source; }
+    const Source& source() const { return m_source; }
+
+    const BBox2D& bbox() const { return m_bbox; }
+    double zmin() const { return m_zmin; }
+    double zmax() const { return m_zmax; }
+    // Plage de la palette étendue aux points insérés
+    void extend_z(double zmin, double zmax);
+    std::size_t width() const { return m_zr.width; }
+    const ZRaster& raster() const { return m_zr; }
+    const Mesh2D& mesh() const { return *m_mesh; }
+
+private:
+    IncrementalTin() = default;
+
+    enum class Insert { Done, Duplicate, Failed };
+    Insert insert_point(double x, double y, double z, Stats& stats);
+
+    void build_index();
+    void init_hull();
+    double orient(std::size_t a, std::size_t b, double px, double py) const;
+    bool in_circumcircle(std::size_t t, double px, double py) const;
+    void touch(std::size_t t);
+
+    static std::size_t next_edge(std::size_t e) { return (e % 3 == 2) ? e - 2 : e + 1; }
+
+    Source m_source;
+    BBox2D m_bbox{0.0, 0.0, 0.0, 0.0};
+    double m_zmin = 0.0;
+    double m_zmax = 0.0;
+    double m_sign = 1.0;                     // +1 : triangles dans le sens trigonométrique
+    std::unique_ptr<Mesh2D> m_mesh;
+    std::vector<std::size_t> m_halfedges;    // Delaunay::NO_EDGE sur l'enveloppe
+    std::unique_ptr<TriangleLocator> m_locator;
+    std::unordered_set<std::size_t> m_hull;  // demi-arêtes de l'enveloppe
+    ZRaster m_zr;
+
+    // tampons de insert_point, réutilisés d'un point à l'autre
+    struct Edge { std::size_t a, b, twin; };
+    std::vector<std::size_t> m_cavity;
+    std::vector<std::size_t> m_visible;      // arêtes d'enveloppe vues depuis le point, hors cavité
+    std::vector<Edge> m_boundary;
+    std::vector<char> m_mark;                // triangles de la cavité courante
+    std::vector<char> m_touched_flag;
+    std::vector<std::size_t> m_touched;      // triangles créés depuis update_raster()
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef MEMSTATS_HPP
+#define MEMSTATS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Mémoire résidente du processus (Linux : /proc/self/status) et pic par
+// étape : le pic (VmHWM) est remis à zéro à l'entrée de chaque étape
+// (/proc/self/clear_refs), le pic d'une étape est reporté sur l'étape
+// englobante. Sans /proc, les mesures valent 0.
+class MemoryStats {
+public:
+    static std::size_t current_rss();
+    static std::size_t peak_rss();
+    static bool reset_peak();
+
+    static void enable(bool on);
+    static bool enabled();
+
+    class Stage {
+    public:
+        explicit Stage(const std::string& name);
+        ~Stage();
+        Stage(const Stage&) = delete;
+        Stage& operator=(const Stage&) = delete;
+
+    private:
+        bool m_active = false;
+    };
+
+    // Tableau : RSS avant, pic pendant (au-dessus de l'entrée), RSS après
+    static void print_report(std::ostream& os);
+};
+
+// Estimations d'empreinte par étape et choix de stratégies sous budget
+// (--memory-budget). Les coûts unitaires suivent les structures du pipeline.
+class MemoryBudget {
+public:
+    // "512M", "4G", "800000K", octets sinon
+    static std::size_t parse_size(const std::string& s);
+
+    // Nombre de points d'un fichier MNT estimé sur ses premières lignes
+    static std::size_t estimate_points(const std::string& path);
+
+    // Lecture + projection : GeoPoint (croissance du vector), Point2D, Point3D
+    static std::size_t input_bytes(std::size_t npoints);
+    // Côté de l'index Grid hors budget (TerrainPipeline::Params)
+    static constexpr std::size_t GRID_SIDE = 1000;
+
+    // Delaunay (structures de delaunator), Mesh2D et index Grid grid_side x grid_side
+    static std::size_t tin_bytes(std::size_t npoints, std::size_t grid_side = GRID_SIDE);
+    // Agrégation par pixel (PointSplatter) : grilles + répartition des points
+    static std::size_t splat_bytes(std::size_t npoints, std::size_t pixels);
+    // Grille z, masque, ombrage, ombres portées, dérivées
+    static std::size_t raster_bytes(std::size_t pixels, bool shading, bool shadows, bool derivatives);
+    // Image RGB en mémoire (absente en sortie projetée)
+    static std::size_t image_bytes(std::size_t pixels);
+
+    struct Plan {
+        bool mmap_output = false;    // couleur écrite dans le fichier projeté
+        bool splat = false;          // pas de TIN complet
+        std::size_t max_points = 0;  // décimation avant Delaunay (0 = aucune)
+        std::size_t grid_side = GRID_SIDE; // index Grid (cellules par côté)
+        std::size_t estimate = 0;    // pic estimé avec ce plan (octets)
+    };
+
+    // resident : mémoire déjà occupée. Stratégies essayées dans l'ordre :
+    // tel quel, sortie projetée (P6 seulement), index Grid réduit, agrégation
+    // par pixel, décimation (avec index réduit).
+    // Lève std::runtime_error (avec l'estimation) si rien ne tient.
+    static Plan plan(std::size_t budget, std::size_t resident, std::size_t npoints, std::size_t pixels,
+                     bool shading, bool shadows, bool derivatives, bool allow_splat, bool allow_mmap);
+
+    static std::string format(std::size_t bytes);
+};
+
+#endif
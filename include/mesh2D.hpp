@@ -10,6 +10,12 @@ struct Vec2 {
     double y = 0.0;
 };
 
+struct Vec3 {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
 struct BBox2D {
     double minx, miny, maxx, maxy;
 };
@@ -37,6 +43,19 @@ public:
 
     double interpolate_z(std::size_t ti, double a, double b, double c) const;
 
+    // Modification en place (insertion incrémentale, IncrementalTin) ;
+    // les normales éventuelles sont à recalculer ensuite
+    std::size_t add_vertex(double x, double y, double z);
+    // ti == triangle_count() : ajout d'un triangle
+    void set_triangle(std::size_t ti, std::size_t ia, std::size_t ib, std::size_t ic);
+
+    // Normales unitaires (z > 0) : une par triangle, et si smooth une par sommet
+    // (moyenne des faces adjacentes pondérée par l'aire).
+    void compute_normals(bool smooth);
+    bool has_normals() const;
+    // Normale au point de coordonnées barycentriques (a,b,c) du triangle ti
+    Vec3 normal_at(std::size_t ti, double a, double b, double c) const;
+
 private:
     static double orient2d(const Vec2& a, const Vec2& b, const Vec2& c);
 
@@ -44,6 +63,8 @@ private:
     std::vector<double> m_coords;              // x0,y0,x1,y1,...
     std::vector<std::size_t> m_triangles;      // a0,b0,c0,a1,b1,c1...
     std::vector<double> m_alts;                // z par sommet
+    std::vector<double> m_tri_normals;         // nx,ny,nz par triangle
+    std::vector<double> m_vtx_normals;         // nx,ny,nz par sommet (si lissage)
 };
 
 #endif
\ No newline at end of file
@@ -1,13 +1,42 @@
 #pragma once
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 class Ombrage {
 public:
+    struct Light {
+        double azimuth_deg;
+        double altitude_deg;
+    };
+
+    // Nombre maximal de lumières pour compute_multi (évaluées en registres)
+    static constexpr std::size_t MAX_LIGHTS = 8;
+
     // azimuth_deg: 0=N, 90=E ; altitude_deg: hauteur du soleil
     // dx, dy: taille du pixel en "mètres monde"
     static std::vector<double> compute(const std::vector<double>& z,std::size_t w, std::size_t h,double dx, double dy,double azimuth_deg = 315.0,double altitude_deg = 45.0);
 
+    // Ombrage multidirectionnel pondéré par l'orientation (type MDOW) :
+    // un seul calcul de gradient par pixel, toutes les lumières évaluées ensuite.
+    // Chaque lumière est pondérée par sin²(exposition - azimut) : les lumières
+    // rasantes par rapport à la pente comptent le plus.
+    static std::vector<double> compute_multi(const std::vector<double>& z,std::size_t w, std::size_t h,double dx, double dy,const std::vector<Light>& lights);
+
+    // Éventail de `count` lumières réparties sur `spread_deg` autour de azimuth_deg
+    static std::vector<Light> light_fan(double azimuth_deg, double altitude_deg, std::size_t count = 4, double spread_deg = 135.0);
+
+    // Ombres portées : balayage de lignes parallèles à l'azimut solaire avec un
+    // horizon courant (coût linéaire en nombre de pixels). Même convention
+    // d'azimut que compute(). Retour : 1 = éclairé, 0 = à l'ombre.
+    // mask (optionnel, vide = tout valide) : les pixels invalides ne portent pas d'ombre.
+    static std::vector<std::uint8_t> cast_shadows(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t w, std::size_t h, double dx, double dy, double azimuth_deg, double altitude_deg);
+
 private:
     static double deg2rad(double d);
+
+    template <std::size_t N>
+    static void compute_multi_n(const std::vector<double>& z, std::size_t w, std::size_t h, double dx, double dy, const std::vector<Light>& lights, std::vector<double>& shade);
+
+    static void copy_borders(std::vector<double>& shade, std::size_t w, std::size_t h);
 };
@@ -0,0 +1,45 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include "threadpool.hpp"
+
+// Nombre de threads de calcul (au moins 1)
+inline std::size_t worker_count() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<std::size_t>(n);
+}
+
+// Découpe [begin, end) en blocs contigus, un par thread : fn(lo, hi).
+// Les blocs sont disjoints, fn ne doit écrire que dans sa plage.
+// Blocs exécutés par le pool partagé (ThreadPool::shared), l'appelant
+// traitant le premier ; appels imbriqués ou concurrents autorisés.
+template <class F>
+void parallel_for(std::size_t begin, std::size_t end, F&& fn, std::size_t min_chunk = 1)
+{
+    if (end <= begin) return;
+
+    const std::size_t n = end - begin;
+    const std::size_t chunks = std::max<std::size_t>(1, std::min(worker_count(), n / std::max<std::size_t>(1, min_chunk)));
+
+    if (chunks == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    const std::size_t per = (n + chunks - 1) / chunks;
+
+    TaskGroup group;
+    for (std::size_t c = 1; c < chunks; ++c) {
+        const std::size_t lo = begin + c * per;
+        const std::size_t hi = std::min(end, lo + per);
+        if (lo >= hi) break;
+        group.run([&fn, lo, hi]() { fn(lo, hi); });
+    }
+    fn(begin, std::min(end, begin + per));
+    group.wait();
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PNG_HPP
+#define PNG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Écriture PNG RGB 8 bits par bandes de lignes, compressée en parallèle :
+// chaque bande est découpée en blocs filtrés puis compressés (deflate brut)
+// sur des threads séparés, le dictionnaire de chaque bloc étant amorcé avec
+// les 32 Ko qui le précèdent. Les blocs se concatènent en un flux zlib
+// unique (Z_SYNC_FLUSH, Adler-32 combinés) écrit en chunks IDAT.
+class PngWriter {
+public:
+    PngWriter(const std::string& filename, std::size_t width, std::size_t height, int level = 6);
+    ~PngWriter();
+
+    PngWriter(const PngWriter&) = delete;
+    PngWriter& operator=(const PngWriter&) = delete;
+
+    // rgb : rows lignes consécutives (3 * width octets chacune), dans l'ordre
+    void write_rows(const std::uint8_t* rgb, std::size_t rows);
+
+    // Vérifie que toutes les lignes ont été reçues et écrit IEND
+    void finish();
+
+    std::size_t rows_written() const { return m_rows; }
+
+    // Image complète en une fois
+    static void write(const std::string& filename, std::size_t width, std::size_t height, const std::vector<std::uint8_t>& rgb, int level = 6);
+
+private:
+    void write_chunk(const char type[4], const std::uint8_t* data, std::size_t size);
+
+    std::ofstream m_ofs;
+    std::size_t m_width;
+    std::size_t m_height;
+    int m_level;
+    std::size_t m_rows = 0;
+    bool m_finished = false;
+
+    std::vector<std::uint8_t> m_prev;  // dernière ligne brute (filtres Up / Paeth)
+    std::vector<std::uint8_t> m_tail;  // derniers 32 Ko filtrés (dictionnaire du bloc suivant)
+    unsigned long m_adler;             // Adler-32 du flux filtré complet
+};
+
+#endif
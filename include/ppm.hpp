@@ -7,6 +7,39 @@
 class PPM{
 public:
     static void write_p6(const std::string& filename,std::size_t width,std::size_t height,const std::vector<std::uint8_t>& rgb);
+
+    // Raster flottant 1 canal (PFM "Pf", little-endian, lignes stockées du bas vers le haut)
+    static void write_pfm(const std::string& filename,std::size_t width,std::size_t height,const std::vector<float>& values);
+
+    // Réécrit en place le rectangle (x0, y0, w, h) d'un P6 existant de
+    // width x height pixels (rgb : w * h * 3 octets) ; false si le fichier est
+    // absent ou d'autres dimensions (à réécrire entièrement)
+    static bool patch_p6(const std::string& filename,std::size_t width,std::size_t height,std::size_t x0,std::size_t y0,std::size_t w,std::size_t h,const std::vector<std::uint8_t>& rgb);
+};
+
+// Fichier P6 préalloué (en-tête + posix_fallocate) dont la zone pixels est projetée
+// en mémoire : l'étape couleur y écrit directement (Rasterizer::colorize vers
+// un pointeur), sans buffer intermédiaire ni copie par ofstream. Les pages
+// sont rendues au noyau de façon asynchrone (msync MS_ASYNC) à la fermeture.
+class MappedP6{
+public:
+    MappedP6(const std::string& filename,std::size_t width,std::size_t height);
+    ~MappedP6();
+
+    MappedP6(const MappedP6&) = delete;
+    MappedP6& operator=(const MappedP6&) = delete;
+
+    // width * height * 3 octets RGB, ligne 0 en haut
+    std::uint8_t* pixels() { return m_pixels; }
+
+    // Démappe et ferme le fichier (appelé par le destructeur sinon)
+    void close();
+
+private:
+    int m_fd = -1;
+    void* m_map = nullptr;
+    std::size_t m_map_size = 0;
+    std::uint8_t* m_pixels = nullptr;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Instrumentation légère : zones imbriquées (RAII) enregistrées dans un tampon
+// par thread, compteurs du chemin critique, histogrammes, export Chrome trace
+// (chrome://tracing, Perfetto). Compilée si MNT_PROFILING vaut 1 (option CMake) ;
+// désactivée à l'exécution, une zone ou un compteur coûte une lecture atomique
+// relâchée et un branchement.
+#ifndef MNT_PROFILING
+#define MNT_PROFILING 1
+#endif
+
+class Profiler {
+public:
+    // Compteurs du chemin critique (sommés sur tous les threads)
+    enum class Counter : unsigned {
+        LocateCalls,       // appels à TriangleLocator::locate
+        LocateCandidates,  // triangles candidats examinés
+        LocateMisses,      // requêtes hors triangulation
+        RasterPixels,      // pixels interpolés par rasterize_z
+        RasterOutside,     // dont hors enveloppe
+        GridTriangles,     // triangles indexés par Grid
+        GridEntries,       // entrées triangle-cellule de l'index
+        COUNT
+    };
+
+    static void enable(bool on);
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Nom stable (les zones ne conservent qu'un pointeur)
+    static const char* intern(const std::string& name);
+
+    class Zone {
+    public:
+        explicit Zone(const char* name)
+        {
+            if (name && enabled()) begin(name);
+        }
+        ~Zone()
+        {
+            if (m_name) end();
+        }
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        void begin(const char* name);
+        void end();
+
+        const char* m_name = nullptr;
+        std::int64_t m_start = 0;
+    };
+
+    static void add(Counter c, std::uint64_t v);
+    static std::uint64_t counter(Counter c);
+
+    // Histogramme nommé (remplace la version précédente du même nom)
+    static void histogram(const char* name, const std::vector<std::uint64_t>& buckets, const std::vector<std::string>& labels);
+
+    // Export au format Chrome trace (événements "X" par thread + compteurs)
+    static void write_chrome_trace(const std::string& path);
+    // Temps cumulé par chemin de zones (parent/enfant), compteurs, histogrammes
+    static void print_summary(std::ostream& os);
+
+    // Vide les tampons (nouvelle mesure)
+    static void reset();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#if MNT_PROFILING
+#define MNT_PROFILE_CONCAT2(a, b) a##b
+#define MNT_PROFILE_CONCAT(a, b) MNT_PROFILE_CONCAT2(a, b)
+#define MNT_PROFILE_ZONE(name) Profiler::Zone MNT_PROFILE_CONCAT(mnt_zone_, __LINE__)(name)
+#define MNT_PROFILE_COUNT(c, v) do { if (Profiler::enabled()) Profiler::add(Profiler::Counter::c, (v)); } while (0)
+#else
+#define MNT_PROFILE_ZONE(name) do {} while (0)
+#define MNT_PROFILE_COUNT(c, v) do {} while (0)
+#endif
+
+#endif
@@ -10,6 +10,9 @@ struct Point2D{
     double y;
 };
 
+// Un Projector n'est pas réentrant, mais chaque instance a son propre
+// contexte PROJ : deux instances (par exemple une copie) peuvent projeter
+// en parallèle depuis deux threads.
 class Projector {
 public:
     Projector(
@@ -19,12 +22,21 @@ public:
         "+x_0=700000 +y_0=6600000 +ellps=GRS80 +units=m +no_defs"
     );
 
+    // Copie : mêmes CRS, contexte et pipeline indépendants
+    Projector(const Projector& other);
+    Projector& operator=(const Projector&) = delete;
+
     ~Projector();
 
     Point2D project(double lon_deg, double lat_deg) const;
 
 private:
+    void init();
+
+    std::string m_src_crs;
+    std::string m_dst_crs;
+    PJ_CONTEXT* C; // contexte propre à l'instance
     PJ* P; // pipeline de transformation
 };
 
-#endif 
\ No newline at end of file
+#endif
@@ -6,15 +6,71 @@
 #include "mesh2D.hpp"
 #include "trianglelocator.hpp"
 #include "colormap.hpp"
+#include "colorstretch.hpp"
+
+// Grille d'altitudes échantillonnée aux centres de pixels (ligne 0 = nord)
+struct ZRaster {
+    std::size_t width = 0;
+    std::size_t height = 0;
+    double dx = 0.0;  // taille pixel (mètres monde)
+    double dy = 0.0;
+    std::vector<double> z;
+    std::vector<std::uint8_t> mask; // 1 = dans la triangulation
+};
 
 class Rasterizer {
     public:
+        // Pixels produits : RGB (P6, PNG) ou RGBA (alpha nul hors enveloppe, tuiles)
+        enum class PixelFormat { RGB, RGBA };
+        static std::size_t channels(PixelFormat f) { return f == PixelFormat::RGBA ? 4 : 3; }
+
+        struct Params {
+            bool ombrage;
+            double azimuth_deg;
+            double altitude_deg;
+            bool multidirectional;     // éventail de lumières (Ombrage::compute_multi)
+            std::size_t light_count;   // nombre de lumières si multidirectional
+            bool cast_shadows;         // ombres portées (Ombrage::cast_shadows)
+            double shadow_strength;    // 0 = invisible, 1 = noir
+            bool tin_shading;          // Lambert sur les normales du maillage (Mesh2D::compute_normals)
+            ColorStretch::Mode stretch; // étirement de la palette (histogramme de la grille z)
+            double stretch_clip_pct;    // écrêtage (%) du mode Percentile
+            PixelFormat format;         // canaux écrits par colorize / render_rgb
+            bool single_precision;      // quantification couleur en float (2x plus de voies SIMD, ±1 niveau aux frontières)
+
+            Params(): ombrage(true), azimuth_deg(315.0), altitude_deg(45.0), multidirectional(false), light_count(4), cast_shadows(false), shadow_strength(0.6), tin_shading(false), stretch(ColorStretch::Mode::Linear), stretch_clip_pct(1.0), format(PixelFormat::RGB), single_precision(false){}
+        };
+
         Rasterizer(const TriangleLocator& locator, BBox2D bbox, double zmin, double zmax);
+        // Sans triangulation : seul colorize() est utilisable (ZRaster fourni par l'appelant)
+        Rasterizer(BBox2D bbox, double zmin, double zmax);
 
         std::vector<std::uint8_t> render_p6_color(std::size_t width,std::size_t& out_height,bool hillshade_enabled = true,double azimuth_deg = 315.0,double altitude_deg = 45.0) const;
+        std::vector<std::uint8_t> render_p6_color(std::size_t width,std::size_t& out_height,const Params& p) const;
+
+        // Hauteur d'image pour width pixels sur l'emprise view (rapport d'aspect conservé, au moins 1)
+        static std::size_t output_height(const BBox2D& view, std::size_t width);
+
+        // Étapes séparées de render_p6_color : interpolation puis ombrage + couleur
+        ZRaster rasterize_z(std::size_t width) const;
+        // Emprise quelconque (tuile) ; zr est réutilisé, sans réallocation si sa capacité suffit
+        void rasterize_z(const BBox2D& view, std::size_t width, ZRaster& zr) const;
+        std::vector<std::uint8_t> colorize(const ZRaster& zr, const Params& p) const;
+        // Variante sans allocation : rgb (zr.width * zr.height * channels(p.format) octets)
+        // fourni par l'appelant, par exemple la projection mémoire de MappedP6.
+        // Le noyau de couleur est choisi une fois par appel parmi des instanciations
+        // spécialisées (ombrage, masque, précision, canaux ; AVX2 si disponible).
+        void colorize(const ZRaster& zr, const Params& p, std::uint8_t* rgb) const;
+
+        // Rendu complet de l'emprise view dans rgb (width * output_height(view, width) * channels(p.format) octets)
+        // fourni par l'appelant ; const et sans état partagé modifié
+        void render_rgb(const BBox2D& view, std::size_t width, const Params& p, std::uint8_t* rgb) const;
 
     private:
-        const TriangleLocator& m_locator;
+        // Passe unique : interpolation, ombrage sur la normale du triangle et couleur
+        void render_tin_shaded(const BBox2D& view, std::size_t width, const Params& p, std::uint8_t* rgb) const;
+
+        const TriangleLocator* m_locator; // nullptr : colorisation seule
         BBox2D m_bbox;
         HaxbyColorMap m_cmap;
         double m_zmin;
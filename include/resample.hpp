@@ -0,0 +1,22 @@
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include <cstddef>
+#include "fourier.hpp"
+#include "rasterise.hpp"
+
+// Rééchantillonnage de la grille filtrée de FourierPreprocess directement
+// aux centres de pixels : remplace l'échantillonnage + Delaunay + Grid
+// quand la grille est déjà régulière et lisse.
+class GridResampler {
+public:
+    enum class Interp { Bilinear, Bicubic };
+
+    // Même géométrie que Rasterizer::rasterize_z (hauteur = bh/bw * width).
+    // Un pixel est valide si la cellule la plus proche l'est ; les poids
+    // bilinéaires sont renormalisés sur les cellules valides. Bicubique :
+    // Catmull-Rom, bilinéaire dès qu'une des 16 cellules manque.
+    static ZRaster resample(const FilteredGrid& g, std::size_t width, Interp interp);
+};
+
+#endif
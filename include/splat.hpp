@@ -0,0 +1,36 @@
+#ifndef SPLAT_HPP
+#define SPLAT_HPP
+
+#include <cstddef>
+#include <vector>
+#include "geopoint.hpp"
+#include "rasterise.hpp"
+
+// Rendu par agrégation directe des points dans les pixels de sortie, pour
+// les levés sur-échantillonnés (plusieurs points par pixel) : pas de TIN
+// complet. Seuls les pixels vides à l'intérieur de l'enveloppe sont
+// interpolés, sur une triangulation des pixels remplis qui les bordent.
+class PointSplatter {
+public:
+    enum class Stat { Mean, Min, Max };
+
+    // Points par pixel à partir duquel le mode automatique choisit l'agrégation
+    static constexpr double AUTO_RATIO = 4.0;
+
+    struct Info {
+        std::size_t splatted = 0;    // pixels avec au moins un point
+        std::size_t ring_points = 0; // sommets de la triangulation de bouchage
+        std::size_t filled = 0;      // pixels vides interpolés
+    };
+
+    static bool worthwhile(std::size_t point_count, std::size_t width, std::size_t height);
+
+    static ZRaster splat(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t width, Stat stat, Info* info = nullptr);
+
+private:
+    // Triangulation des pixels remplis voisins d'un pixel vide, puis
+    // interpolation barycentrique des pixels vides qu'elle recouvre
+    static std::size_t fill_holes(ZRaster& zr, const BBox2D& bbox, std::size_t& ring_points);
+};
+
+#endif
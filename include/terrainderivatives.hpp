@@ -0,0 +1,28 @@
+#ifndef TERRAINDERIVATIVES_HPP
+#define TERRAINDERIVATIVES_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "colormap.hpp"
+
+// Dérivées du terrain calculées en une seule passe (stencil 3x3 Evans-Young)
+// sur la grille z rasterisée. Pixels invalides -> NaN.
+class TerrainDerivatives {
+public:
+    struct Result {
+        std::size_t w = 0, h = 0;
+        std::vector<float> slope;        // pente (degrés)
+        std::vector<float> aspect;       // exposition (degrés, 0=N, sens horaire ; -1 si plat)
+        std::vector<float> plan_curv;    // courbure en plan (1/m, convexe > 0)
+        std::vector<float> profile_curv; // courbure de profil (1/m, convexe > 0)
+    };
+
+    // z, mask: grille w x h (ligne 0 = nord) ; dx, dy: taille du pixel en mètres
+    static Result compute(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t w, std::size_t h, double dx, double dy);
+
+    // Colorisation d'un raster (palette étirée sur [min, max] des valeurs finies)
+    static std::vector<std::uint8_t> colorize(const std::vector<float>& v, const HaxbyColorMap& cmap);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef TERRAINMOSAIC_HPP
+#define TERRAINMOSAIC_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "geopoint.hpp"
+#include "mesh2D.hpp"
+#include "projector.hpp"
+#include "terrainstream.hpp"
+
+// Levé livré en tuiles adjacentes : les fichiers sont chargés en parallèle
+// (un TerrainStream par fichier sur le pool partagé, chacun avec sa copie du
+// Projector) puis fusionnés dans l'ordre de la liste. Seuls les points situés
+// dans le recouvrement des emprises de deux tuiles passent par une table de
+// hachage spatiale : un point à moins de seam_tolerance d'un point retenu
+// d'un fichier précédent est écarté. Les doublons internes à un fichier sont
+// conservés, comme avec un fichier unique.
+class TerrainMosaic {
+public:
+    struct Params {
+        double seam_tolerance;          // distance (m) sous laquelle deux points de tuiles différentes sont confondus (0 : pas de dédoublonnage)
+        TerrainStream::Params stream;   // découpage de chaque fichier
+
+        Params(): seam_tolerance(0.01){}
+    };
+
+    struct Result {
+        std::vector<Point3D> points;    // x, y projetés, z altitude ; fichiers dans l'ordre de la liste
+        BBox2D bbox{0.0, 0.0, 0.0, 0.0};
+        double zmin = 0.0;
+        double zmax = 0.0;
+        std::size_t files = 0;
+        std::size_t chunks = 0;         // blocs lus, tous fichiers confondus
+        std::size_t seam_points = 0;    // points situés dans un recouvrement
+        std::size_t duplicates = 0;     // points écartés
+    };
+
+    // Liste séparée par des virgules dont chaque élément peut être un motif
+    // glob (tuiles/*.txt, développé en ordre lexicographique) ; dir non vide
+    // est préfixé à chaque élément. Un motif sans correspondance est une erreur.
+    static std::vector<std::string> expand(const std::string& spec, const std::string& dir = "");
+
+    // Mêmes erreurs que TerrainStream::load, préfixées du fichier en cause
+    // quand il y en a plusieurs
+    static Result load(const std::vector<std::string>& paths, const Projector& projector, const Params& p = Params());
+
+private:
+    // Marque dans drop[f] les points de la tuile f confondus avec une tuile précédente
+    static void dedup_seams(const std::vector<TerrainStream::Result>& tiles, double tol, std::vector<std::vector<char>>& drop, Result& r);
+};
+
+#endif
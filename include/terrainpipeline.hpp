@@ -0,0 +1,79 @@
+#ifndef TERRAINPIPELINE_HPP
+#define TERRAINPIPELINE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "geopoint.hpp"
+#include "mesh2D.hpp"
+#include "grid.hpp"
+#include "trianglelocator.hpp"
+#include "rasterise.hpp"
+#include "trianglefilter.hpp"
+
+// Pipeline TIN réutilisable (bibliothèque libmnt) : lecture, projection,
+// triangulation et index construits une fois, puis autant de rendus que voulu.
+// L'état est en lecture seule après construction : render() et render_z()
+// peuvent être appelés en parallèle depuis plusieurs threads, chaque appel
+// n'utilisant que ses propres tampons (ou ceux fournis par l'appelant).
+class TerrainPipeline {
+public:
+    struct Params {
+        std::size_t grid_nx;    // cellules de l'index Grid
+        std::size_t grid_ny;
+        Grid::Overlap grid_overlap; // cellules recoupées (Exact) ou bbox de chaque triangle
+        bool tin_normals;       // normales du maillage (Rasterizer::Params::tin_shading)
+        bool smooth_normals;    // normales lissées par sommet
+        TriangleFilter::Params filter; // triangles écartés avant l'index (lacunes, bords concaves)
+
+        Params(): grid_nx(1000), grid_ny(1000), grid_overlap(Grid::Overlap::Exact), tin_normals(false), smooth_normals(false){}
+    };
+
+    // Fichier MNT (lat lon alt) : lecture puis projection (Projector par défaut)
+    explicit TerrainPipeline(const std::string& filepath, const Params& p = Params());
+    // Tuiles adjacentes chargées en parallèle, raccords dédoublonnés (TerrainMosaic)
+    explicit TerrainPipeline(const std::vector<std::string>& paths, const Params& p = Params());
+    // Points déjà projetés (x, y en mètres), par exemple issus de FourierPreprocess::run
+    explicit TerrainPipeline(const std::vector<Point3D>& pts, const Params& p = Params());
+    // Emprise et plage de la palette imposées (points décimés ou filtrés d'un levé plus large)
+    TerrainPipeline(const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, const Params& p = Params());
+
+    TerrainPipeline(TerrainPipeline&&) = default;
+    TerrainPipeline& operator=(TerrainPipeline&&) = default;
+
+    const BBox2D& bbox() const { return m_bbox; }
+    double zmin() const { return m_zmin; }
+    double zmax() const { return m_zmax; }
+    const Mesh2D& mesh() const { return *m_mesh; }
+    // Bilan du filtrage (Params::filter), vide sans filtrage
+    const TriangleFilter::Stats& filter_stats() const { return m_filter; }
+    // Rasterizer sur l'emprise complète (palette chargée une fois)
+    const Rasterizer& rasterizer() const { return *m_rasterizer; }
+
+    // Hauteur de l'image de width pixels sur view
+    static std::size_t height(const BBox2D& view, std::size_t width);
+    static std::size_t rgb_size(const BBox2D& view, std::size_t width, Rasterizer::PixelFormat format = Rasterizer::PixelFormat::RGB);
+
+    // Rendu de view dans rgb, tampon de rgb_size(view, width, p.format) octets (capacity) fourni par l'appelant
+    void render(const BBox2D& view, std::size_t width, const Rasterizer::Params& p, std::uint8_t* rgb, std::size_t capacity) const;
+    // Emprise complète, image allouée
+    std::vector<std::uint8_t> render(std::size_t width, const Rasterizer::Params& p) const;
+    // Grille z seule (dérivées, export) ; zr est réutilisé d'un appel à l'autre
+    void render_z(const BBox2D& view, std::size_t width, ZRaster& zr) const;
+
+private:
+    void build(const std::vector<Point3D>& pts, const Params& p);
+    static BBox2D bounds(const std::vector<Point3D>& pts, double& zmin, double& zmax);
+
+    // Pointeurs : locator et rasterizer référencent le maillage, l'objet reste déplaçable
+    std::unique_ptr<Mesh2D> m_mesh;
+    std::unique_ptr<TriangleLocator> m_locator;
+    std::unique_ptr<Rasterizer> m_rasterizer;
+    BBox2D m_bbox{0.0, 0.0, 0.0, 0.0};
+    double m_zmin = 0.0;
+    double m_zmax = 0.0;
+    TriangleFilter::Stats m_filter;
+};
+
+#endif
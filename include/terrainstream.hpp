@@ -0,0 +1,53 @@
+#ifndef TERRAINSTREAM_HPP
+#define TERRAINSTREAM_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "geopoint.hpp"
+#include "mesh2D.hpp"
+#include "projector.hpp"
+
+// Lecture et projection en flux (équivalent de TerrainData + TerrainProjected
+// sans vecteur de GeoPoint complet). Le fichier projeté en mémoire est découpé
+// en blocs de lignes analysés par les tâches du pool partagé ; chaque bloc est
+// projeté, dans l'ordre du fichier, dès qu'il est prêt, pendant que les blocs
+// suivants sont encore analysés. Emprise et plage d'altitudes sont réduites
+// au fil des blocs. PROJ n'étant pas réentrant, un seul bloc est projeté à la fois.
+class TerrainStream {
+public:
+    struct Params {
+        std::size_t chunk_bytes;   // taille nominale d'un bloc (coupé en fin de ligne)
+        std::size_t max_inflight;  // blocs analysés d'avance (0 : 2 x threads)
+        std::size_t offset;        // premier octet lu, en début de ligne (suite d'un fichier déjà lu)
+        std::size_t first_line;    // lignes avant offset (numéros des lignes mal formées)
+
+        Params(): chunk_bytes((std::size_t)4 << 20), max_inflight(0), offset(0), first_line(0){}
+    };
+
+    struct Result {
+        std::vector<Point3D> points;  // x, y projetés, z altitude, ordre du fichier
+        BBox2D bbox{0.0, 0.0, 0.0, 0.0};
+        double zmin = 0.0;
+        double zmax = 0.0;
+        std::size_t chunks = 0;
+        std::size_t bytes = 0;        // taille du fichier au moment de la lecture
+        std::size_t lines = 0;        // lignes lues (first_line compris)
+    };
+
+    // Mêmes erreurs que TerrainData::load_data_from_file (fichier absent,
+    // vide, ligne mal formée avec son numéro). Avec offset > 0, une suite
+    // vide n'est pas une erreur.
+    static Result load(const std::string& filepath, const Projector& projector, const Params& p = Params());
+
+private:
+    struct Chunk {
+        std::vector<GeoPoint> pts;
+        std::size_t lines = 0;     // lignes du bloc (vides comprises)
+        std::size_t bad_line = 0;  // 1re ligne mal formée (numéro local, 0 = aucune)
+    };
+
+    static Chunk parse(const char* data, std::size_t size, std::size_t chunk_bytes, std::size_t index);
+};
+
+#endif
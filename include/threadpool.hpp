@@ -0,0 +1,87 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads à vol de tâches, partagé par toutes les étapes parallèles
+// (parallel_for, lecture en flux). Chaque worker a sa file : il dépile ses
+// propres tâches par la fin (LIFO, données chaudes) et vole celles des autres
+// par le début. Les threads extérieurs au pool déposent dans une file
+// d'injection. Un thread qui attend un TaskGroup exécute des tâches en
+// attendant : des parallel_for imbriqués ne bloquent jamais le pool.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // Pool du processus : worker_count() - 1 workers, l'appelant faisant le dernier
+    static ThreadPool& shared();
+
+    explicit ThreadPool(std::size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t workers() const { return m_threads.size(); }
+
+    void submit(Task t);
+
+    // Exécute une tâche en attente (locale, injectée ou volée) ; false si aucune
+    bool run_one();
+
+    // Attente passive jusqu'à une nouvelle tâche ou done() vrai
+    void wait_for_work(const std::function<bool()>& done);
+    // Réveille les threads en attente (fin d'un TaskGroup)
+    void notify_all();
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(std::size_t index);
+    bool pop_local(std::size_t index, Task& t);
+    bool pop_front(Queue& q, Task& t);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // une par worker
+    Queue m_inject;                                // threads extérieurs
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;                 // protège l'attente (m_cv)
+    std::condition_variable m_cv;
+    std::atomic<std::size_t> m_queued{0};
+    std::atomic<std::size_t> m_steal_seed{0};
+    bool m_stop = false;
+};
+
+// Groupe de tâches attendues ensemble ; la première exception est relancée par wait()
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) : m_pool(pool) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> fn);
+    // Aide le pool jusqu'à la fin des tâches du groupe
+    void wait();
+
+private:
+    ThreadPool& m_pool;
+    std::atomic<std::size_t> m_pending{0};
+    std::mutex m_error_mutex;
+    std::exception_ptr m_error;
+};
+
+#endif
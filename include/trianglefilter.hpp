@@ -0,0 +1,43 @@
+#ifndef TRIANGLEFILTER_HPP
+#define TRIANGLEFILTER_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Filtrage de la triangulation de Delaunay, qui couvre toute l'enveloppe
+// convexe : les lacunes de couverture (entre profils sonar, le long d'une
+// côte concave) y sont comblées par de grands triangles effilés qui
+// interpolent un terrain fictif et encombrent de nombreuses cellules de Grid.
+// Un triangle est écarté si une de ses arêtes dépasse la longueur maximale,
+// ou si son cercle circonscrit a un rayon supérieur à alpha (forme alpha :
+// seuls restent les triangles d'une « boule vide » de rayon alpha).
+// Les pixels qu'ils couvraient sont hors triangulation (masque nul).
+class TriangleFilter {
+public:
+    struct Params {
+        double max_edge;      // longueur d'arête maximale (m, 0 : pas de limite)
+        double edge_factor;   // longueur maximale relative à la médiane des arêtes (0 : pas de limite)
+        double alpha;         // rayon circonscrit maximal (m, 0 : pas de forme alpha)
+
+        Params(): max_edge(0.0), edge_factor(0.0), alpha(0.0){}
+
+        bool enabled() const { return max_edge > 0.0 || edge_factor > 0.0 || alpha > 0.0; }
+    };
+
+    struct Stats {
+        std::size_t kept = 0;
+        std::size_t long_edge = 0;   // écartés par la longueur d'arête
+        std::size_t alpha = 0;       // écartés par la forme alpha seule
+        double max_edge = 0.0;       // seuil de longueur appliqué (m, 0 : aucun)
+    };
+
+    // coords = {x0,y0,...}, triangles = indices de sommets par triangle
+    // (Delaunay::triangulate) ; triangles compactés en place, ordre conservé.
+    // Lève std::runtime_error si aucun triangle ne reste.
+    static Stats cull(const std::vector<double>& coords, std::vector<std::size_t>& triangles, const Params& p);
+
+    // Médiane des longueurs d'arêtes, sur un échantillon régulier des triangles
+    static double median_edge(const std::vector<double>& coords, const std::vector<std::size_t>& triangles);
+};
+
+#endif
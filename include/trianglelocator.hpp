@@ -17,6 +17,11 @@ public:
     std::optional<TriHit> locate(double x, double y) const;
     std::optional<double> interpolate(double x, double y) const;
 
+    const Mesh2D& mesh() const;
+    const Grid& index() const;
+    // Index modifiable (mise à jour locale après insertion, IncrementalTin)
+    Grid& index();
+
 private:
     const Mesh2D& m_mesh;
     Grid m_index;
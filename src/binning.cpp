@@ -0,0 +1,220 @@
+#include "binning.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+// Même convention que FourierPreprocess : y inversé, points hors [0,1[ ignorés
+static inline std::uint64_t cell_of(const Point3D& p, const BBox2D& bb, double bw, double bh, std::size_t gw, std::size_t gh)
+{
+    const double tx = (p.x - bb.minx) / bw;
+    const double ty = (bb.maxy - p.y) / bh;
+    if (!(tx >= 0.0 && tx < 1.0 && ty >= 0.0 && ty < 1.0)) return PointBinner::NO_CELL;
+
+    const std::size_t ix = std::min<std::size_t>(gw - 1, (std::size_t)(tx * (double)gw));
+    const std::size_t iy = std::min<std::size_t>(gh - 1, (std::size_t)(ty * (double)gh));
+    return (std::uint64_t)iy * gw + ix;
+}
+
+PointBinner::Result PointBinner::bin(const std::vector<Point3D>& pts, const BBox2D& bb, std::size_t gw, std::size_t gh, unsigned stats)
+{
+    MNT_PROFILE_ZONE("binning");
+    if (gw == 0 || gh == 0) throw std::runtime_error("PointBinner: grille vide.");
+    if (bb.maxx <= bb.minx || bb.maxy <= bb.miny) throw std::runtime_error("PointBinner: bbox invalide.");
+
+    Result r;
+    r.gw = gw;
+    r.gh = gh;
+
+    const std::size_t cells = gw * gh;
+    r.count.assign(cells, 0);
+    if (stats & MEAN)   r.mean.assign(cells, 0.0);
+    if (stats & MIN)    r.min.assign(cells, 0.0);
+    if (stats & MAX)    r.max.assign(cells, 0.0);
+    if (stats & MEDIAN) r.median.assign(cells, 0.0);
+
+    // Grilles privées tant que leur fusion coûte moins que le passage sur les points
+    const std::size_t threads = worker_count();
+    const bool small_grid = cells * threads <= pts.size() && cells * threads * 32 <= ((std::size_t)256 << 20);
+
+    if (!(stats & MEDIAN) && (small_grid || threads == 1)) {
+        bin_private_grids(pts, bb, stats, r);
+    } else {
+        bin_partitioned(pts, bb, stats, r);
+    }
+    return r;
+}
+
+void PointBinner::bin_private_grids(const std::vector<Point3D>& pts, const BBox2D& bb, unsigned stats, Result& r)
+{
+    const std::size_t gw = r.gw, gh = r.gh, cells = gw * gh;
+    const double bw = bb.maxx - bb.minx;
+    const double bh = bb.maxy - bb.miny;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    struct Partial {
+        std::vector<std::uint32_t> cnt;
+        std::vector<double> sum, mn, mx;
+    };
+
+    // une grille par bloc de points, rangée à l'indice du bloc : la fusion
+    // suit l'ordre des points quel que soit l'ordre de fin des threads
+    const std::size_t nchunks = std::max<std::size_t>(1, std::min(worker_count(), pts.size() / (1 << 16)));
+    const std::size_t per_chunk = (pts.size() + nchunks - 1) / nchunks;
+    std::vector<std::unique_ptr<Partial>> partials(nchunks);
+
+    parallel_for(0, nchunks, [&](std::size_t c0, std::size_t c1) {
+        for (std::size_t c = c0; c < c1; ++c) {
+            auto part = std::make_unique<Partial>();
+            part->cnt.assign(cells, 0);
+            if (stats & MEAN) part->sum.assign(cells, 0.0);
+            if (stats & MIN)  part->mn.assign(cells, inf);
+            if (stats & MAX)  part->mx.assign(cells, -inf);
+
+            const std::size_t hi = std::min(pts.size(), (c + 1) * per_chunk);
+            for (std::size_t i = c * per_chunk; i < hi; ++i) {
+                const std::uint64_t id = cell_of(pts[i], bb, bw, bh, gw, gh);
+                if (id == NO_CELL) continue;
+                const double z = pts[i].z;
+                part->cnt[id]++;
+                if (stats & MEAN) part->sum[id] += z;
+                if (stats & MIN)  part->mn[id] = std::min(part->mn[id], z);
+                if (stats & MAX)  part->mx[id] = std::max(part->mx[id], z);
+            }
+            partials[c] = std::move(part);
+        }
+    });
+
+    // Fusion parallèle par plages de cellules
+    parallel_for(0, cells, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t id = lo; id < hi; ++id) {
+            std::uint32_t n = 0;
+            double sum = 0.0, mn = inf, mx = -inf;
+            for (const auto& p : partials) {
+                n += p->cnt[id];
+                if (stats & MEAN) sum += p->sum[id];
+                if (stats & MIN)  mn = std::min(mn, p->mn[id]);
+                if (stats & MAX)  mx = std::max(mx, p->mx[id]);
+            }
+            r.count[id] = n;
+            if (n == 0) continue;
+            if (stats & MEAN) r.mean[id] = sum / (double)n;
+            if (stats & MIN)  r.min[id] = mn;
+            if (stats & MAX)  r.max[id] = mx;
+        }
+    }, 4096);
+}
+
+void PointBinner::bin_partitioned(const std::vector<Point3D>& pts, const BBox2D& bb, unsigned stats, Result& r)
+{
+    const std::size_t gw = r.gw, gh = r.gh;
+    const double bw = bb.maxx - bb.minx;
+    const double bh = bb.maxy - bb.miny;
+
+    const std::size_t threads = worker_count();
+    const std::size_t nbands = std::min(gh, 4 * threads);
+    const std::size_t nchunks = std::max<std::size_t>(1, std::min(threads, pts.size() / 4096));
+    const std::size_t per_chunk = (pts.size() + nchunks - 1) / nchunks;
+
+    // premières lignes de chaque bande
+    std::vector<std::size_t> band_row(nbands + 1);
+    for (std::size_t b = 0; b <= nbands; ++b) band_row[b] = b * gh / nbands;
+    auto band_of_row = [&](std::size_t iy) {
+        std::size_t b = iy * nbands / gh;
+        while (b + 1 < nbands && band_row[b + 1] <= iy) ++b;
+        while (b > 0 && band_row[b] > iy) --b;
+        return b;
+    };
+
+    // 1) comptage par (bloc de points, bande)
+    std::vector<std::size_t> counts(nchunks * nbands, 0);
+    parallel_for(0, nchunks, [&](std::size_t c0, std::size_t c1) {
+        for (std::size_t c = c0; c < c1; ++c) {
+            std::size_t* cnt = &counts[c * nbands];
+            const std::size_t hi = std::min(pts.size(), (c + 1) * per_chunk);
+            for (std::size_t i = c * per_chunk; i < hi; ++i) {
+                const std::uint64_t id = cell_of(pts[i], bb, bw, bh, gw, gh);
+                if (id != NO_CELL) cnt[band_of_row(id / gw)]++;
+            }
+        }
+    });
+
+    // 2) décalages : bandes contiguës, blocs dans l'ordre à l'intérieur d'une bande
+    std::vector<std::size_t> band_start(nbands + 1, 0);
+    std::vector<std::size_t> offsets(nchunks * nbands, 0);
+    std::size_t acc = 0;
+    for (std::size_t b = 0; b < nbands; ++b) {
+        band_start[b] = acc;
+        for (std::size_t c = 0; c < nchunks; ++c) {
+            offsets[c * nbands + b] = acc;
+            acc += counts[c * nbands + b];
+        }
+    }
+    band_start[nbands] = acc;
+
+    // 3) dispersion : cellule locale à la bande + altitude
+    std::vector<std::uint32_t> local(acc);
+    std::vector<double> zs(acc);
+    parallel_for(0, nchunks, [&](std::size_t c0, std::size_t c1) {
+        for (std::size_t c = c0; c < c1; ++c) {
+            std::size_t* off = &offsets[c * nbands];
+            const std::size_t hi = std::min(pts.size(), (c + 1) * per_chunk);
+            for (std::size_t i = c * per_chunk; i < hi; ++i) {
+                const std::uint64_t id = cell_of(pts[i], bb, bw, bh, gw, gh);
+                if (id == NO_CELL) continue;
+                const std::size_t b = band_of_row(id / gw);
+                const std::size_t k = off[b]++;
+                local[k] = (std::uint32_t)(id - band_row[b] * gw);
+                zs[k] = pts[i].z;
+            }
+        }
+    });
+
+    // 4) agrégation : chaque bande n'écrit que ses propres lignes
+    parallel_for(0, nbands, [&](std::size_t b0, std::size_t b1) {
+        std::vector<std::size_t> cell_off;
+        std::vector<double> sorted;
+
+        for (std::size_t b = b0; b < b1; ++b) {
+            const std::size_t first = band_row[b] * gw;
+            const std::size_t ncells = (band_row[b + 1] - band_row[b]) * gw;
+            const std::size_t s0 = band_start[b], s1 = band_start[b + 1];
+
+            for (std::size_t k = s0; k < s1; ++k) {
+                const std::size_t id = first + local[k];
+                const double z = zs[k];
+                const std::uint32_t n = ++r.count[id];
+                if (stats & MEAN) r.mean[id] += z;
+                if (stats & MIN)  r.min[id] = (n == 1) ? z : std::min(r.min[id], z);
+                if (stats & MAX)  r.max[id] = (n == 1) ? z : std::max(r.max[id], z);
+            }
+            if (stats & MEAN) {
+                for (std::size_t c = 0; c < ncells; ++c) {
+                    if (r.count[first + c]) r.mean[first + c] /= (double)r.count[first + c];
+                }
+            }
+
+            if (stats & MEDIAN) {
+                // tri par dénombrement des altitudes de la bande par cellule
+                cell_off.assign(ncells + 1, 0);
+                for (std::size_t c = 0; c < ncells; ++c) cell_off[c + 1] = cell_off[c] + r.count[first + c];
+                sorted.resize(s1 - s0);
+                std::vector<std::size_t> cursor(cell_off.begin(), cell_off.end() - 1);
+                for (std::size_t k = s0; k < s1; ++k) sorted[cursor[local[k]]++] = zs[k];
+
+                for (std::size_t c = 0; c < ncells; ++c) {
+                    const std::size_t n = cell_off[c + 1] - cell_off[c];
+                    if (n == 0) continue;
+                    double* v = sorted.data() + cell_off[c];
+                    std::nth_element(v, v + n / 2, v + n);
+                    double med = v[n / 2];
+                    if (n % 2 == 0) med = 0.5 * (med + *std::max_element(v, v + n / 2));
+                    r.median[first + c] = med;
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,147 @@
+#include "colorkernel.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "colormap.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MNT_X86_DISPATCH 1
+#define MNT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define MNT_X86_DISPATCH 0
+#define MNT_ALWAYS_INLINE inline
+#endif
+
+namespace {
+
+// Indices dans la table : paramètres __restrict pour que l'accès indexé
+// à base[] (gather) ne soit pas considéré comme aliasant les sorties
+template <bool Shaded, bool Masked>
+MNT_ALWAYS_INLINE void lut_index(const std::int32_t* __restrict zq, const std::int32_t* __restrict sq, const std::uint8_t* __restrict mask,
+                                 const std::uint32_t* __restrict base, std::uint32_t* __restrict idx, std::size_t w)
+{
+    for (std::size_t i = 0; i < w; ++i) {
+        std::uint32_t k = base[zq[i]];
+        if constexpr (Shaded) k += (std::uint32_t)sq[i];
+        else k += HaxbyColorMap::SHADE_LEVELS - 1; // facteur 1
+        if constexpr (Masked) idx[i] = mask[i] ? k : HaxbyColorMap::INVALID_INDEX;
+        else idx[i] = k;
+    }
+}
+
+// Corps commun : boucles séparées pour que chacune se vectorise
+// (conversions et bornes d'une part, accès indexé à la table d'autre part)
+template <bool Shaded, bool Masked, class Real, std::size_t Channels>
+MNT_ALWAYS_INLINE void color_rows(const ColorRows& a, std::size_t j0, std::size_t j1)
+{
+    const std::size_t w = a.width;
+    const Real zq_max = (Real)(HaxbyColorMap::Z_LEVELS - 1);
+    const Real sq_max = (Real)(HaxbyColorMap::SHADE_LEVELS - 1);
+    const Real zmin = (Real)a.zmin;
+    const Real zscale = (Real)a.zscale;
+    const std::uint32_t* __restrict base = a.base;
+    const std::uint8_t* __restrict lut = a.lut;
+
+    std::vector<std::int32_t> zq_row(w), sq_row(Shaded ? w : 0);
+    std::vector<std::uint32_t> idx_row(w);
+    std::int32_t* __restrict zq = zq_row.data();
+    std::int32_t* __restrict sq = sq_row.data();
+    std::uint32_t* __restrict idx = idx_row.data();
+
+    for (std::size_t j = j0; j < j1; ++j) {
+        const double* __restrict zrow = a.z + j * w;
+        const std::uint8_t* __restrict mrow = a.mask + j * w;
+
+        // a) quantification altitude (et ombrage)
+        for (std::size_t i = 0; i < w; ++i) {
+            const Real t = std::min(std::max(((Real)zrow[i] - zmin) * zscale, (Real)0), zq_max);
+            zq[i] = (std::int32_t)(t + (Real)0.5);
+        }
+        if constexpr (Shaded) {
+            const double* __restrict srow = a.shade + j * w;
+            for (std::size_t i = 0; i < w; ++i) {
+                const Real s = std::min(std::max((Real)0.35 + (Real)0.65 * (Real)srow[i], (Real)0), (Real)1);
+                sq[i] = (std::int32_t)(s * sq_max + (Real)0.5);
+            }
+        }
+
+        // b) indice dans la LUT ombrée (noir hors hull)
+        lut_index<Shaded, Masked>(zq, sq, mrow, base, idx, w);
+
+        // c) lecture de la table
+        std::uint8_t* __restrict out = a.out + Channels * j * w;
+        for (std::size_t i = 0; i < w; ++i) {
+            const std::uint8_t* c = lut + 3 * (std::size_t)idx[i];
+            out[Channels * i + 0] = c[0];
+            out[Channels * i + 1] = c[1];
+            out[Channels * i + 2] = c[2];
+            if constexpr (Channels == 4) {
+                out[Channels * i + 3] = (!Masked || idx[i] != HaxbyColorMap::INVALID_INDEX) ? 255 : 0;
+            }
+        }
+    }
+}
+
+template <bool Shaded, bool Masked, class Real, std::size_t Channels>
+void color_rows_generic(const ColorRows& a, std::size_t j0, std::size_t j1)
+{
+    color_rows<Shaded, Masked, Real, Channels>(a, j0, j1);
+}
+
+#if MNT_X86_DISPATCH
+// Même corps compilé pour AVX2 (sans FMA : arrondis identiques à la version générique)
+template <bool Shaded, bool Masked, class Real, std::size_t Channels>
+__attribute__((target("avx2"))) void color_rows_avx2(const ColorRows& a, std::size_t j0, std::size_t j1)
+{
+    color_rows<Shaded, Masked, Real, Channels>(a, j0, j1);
+}
+#endif
+
+bool use_avx2()
+{
+#if MNT_X86_DISPATCH
+    static const bool on = __builtin_cpu_supports("avx2") && !std::getenv("MNT_NO_AVX2");
+    return on;
+#else
+    return false;
+#endif
+}
+
+template <bool Shaded, bool Masked, class Real, std::size_t Channels>
+ColorKernels::Kernel pick_isa()
+{
+#if MNT_X86_DISPATCH
+    if (use_avx2()) return &color_rows_avx2<Shaded, Masked, Real, Channels>;
+#endif
+    return &color_rows_generic<Shaded, Masked, Real, Channels>;
+}
+
+template <bool Shaded, bool Masked, class Real>
+ColorKernels::Kernel pick_channels(std::size_t channels)
+{
+    return channels == 4 ? pick_isa<Shaded, Masked, Real, 4>() : pick_isa<Shaded, Masked, Real, 3>();
+}
+
+template <bool Shaded, bool Masked>
+ColorKernels::Kernel pick_precision(bool single, std::size_t channels)
+{
+    return single ? pick_channels<Shaded, Masked, float>(channels) : pick_channels<Shaded, Masked, double>(channels);
+}
+
+template <bool Shaded>
+ColorKernels::Kernel pick_mask(bool masked, bool single, std::size_t channels)
+{
+    return masked ? pick_precision<Shaded, true>(single, channels) : pick_precision<Shaded, false>(single, channels);
+}
+
+}
+
+ColorKernels::Kernel ColorKernels::select(bool shaded, bool masked, bool single_precision, std::size_t channels)
+{
+    return shaded ? pick_mask<true>(masked, single_precision, channels) : pick_mask<false>(masked, single_precision, channels);
+}
+
+const char* ColorKernels::isa()
+{
+    return use_avx2() ? "avx2" : "generique";
+}
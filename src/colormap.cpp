@@ -57,14 +57,17 @@ void HaxbyColorMap::load_cpt(const std::string& filepath)
     std::sort(m_segments.begin(), m_segments.end(),
               [](const Segment& a, const Segment& b){ return a.t0 < b.t0; });
 
-    build_lut_256();
+    build_lut();
+    build_shaded_lut();
     m_ready = true;
 }
 
-void HaxbyColorMap::build_lut_256()
+void HaxbyColorMap::build_lut()
 {
-    for (int i = 0; i < 256; ++i) {
-        const double t = (double)i / 255.0;
+    m_lut.assign(Z_LEVELS, RGB{0, 0, 0});
+
+    for (std::uint32_t i = 0; i < Z_LEVELS; ++i) {
+        const double t = (double)i / (double)(Z_LEVELS - 1);
 
         // Trouver le segment contenant t
         const Segment* seg = nullptr;
@@ -84,6 +87,22 @@ void HaxbyColorMap::build_lut_256()
     }
 }
 
+void HaxbyColorMap::build_shaded_lut()
+{
+    m_shaded.assign(((std::size_t)Z_LEVELS * SHADE_LEVELS + 1) * 3, 0);
+
+    for (std::uint32_t zq = 0; zq < Z_LEVELS; ++zq) {
+        for (std::uint32_t sq = 0; sq < SHADE_LEVELS; ++sq) {
+            const RGB c = shade(m_lut[zq], (double)sq / (double)(SHADE_LEVELS - 1));
+            const std::size_t k = 3 * ((std::size_t)zq * SHADE_LEVELS + sq);
+            m_shaded[k + 0] = c.r;
+            m_shaded[k + 1] = c.g;
+            m_shaded[k + 2] = c.b;
+        }
+    }
+    // dernière entrée (INVALID_INDEX) : noir
+}
+
 RGB HaxbyColorMap::color(double z, double zmin, double zmax) const
 {
     if (!m_ready) return {0,0,0};
@@ -92,7 +111,7 @@ RGB HaxbyColorMap::color(double z, double zmin, double zmax) const
     double t = (z - zmin) / (zmax - zmin);
     t = std::clamp(t, 0.0, 1.0);
 
-    const int idx = (int)std::lround(t * 255.0);
+    const int idx = (int)std::lround(t * (double)(Z_LEVELS - 1));
     return m_lut[(std::size_t)idx];
 }
 
@@ -0,0 +1,103 @@
+#include "colorstretch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include "colormap.hpp"
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+std::vector<std::uint16_t> ColorStretch::identity()
+{
+    std::vector<std::uint16_t> remap(HaxbyColorMap::Z_LEVELS);
+    for (std::uint32_t b = 0; b < HaxbyColorMap::Z_LEVELS; ++b) remap[b] = (std::uint16_t)b;
+    return remap;
+}
+
+std::vector<std::uint64_t> ColorStretch::histogram(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, double zmin, double zmax, std::size_t levels)
+{
+    const double zq_max = (double)(levels - 1);
+    const double zscale = (zmax > zmin) ? zq_max / (zmax - zmin) : 0.0;
+
+    std::vector<std::uint64_t> hist(levels, 0);
+    std::mutex merge;
+
+    parallel_for(0, z.size(), [&](std::size_t lo, std::size_t hi) {
+        std::vector<std::uint64_t> local(levels, 0);
+        for (std::size_t id = lo; id < hi; ++id) {
+            if (!mask.empty() && !mask[id]) continue;
+            const double t = std::min(std::max((z[id] - zmin) * zscale, 0.0), zq_max);
+            local[(std::size_t)(t + 0.5)]++;
+        }
+
+        std::lock_guard<std::mutex> lock(merge);
+        for (std::size_t b = 0; b < levels; ++b) hist[b] += local[b];
+    }, 1 << 16);
+
+    return hist;
+}
+
+void ColorStretch::rank_range(const std::vector<std::uint64_t>& hist, double zmin, double zmax, std::uint64_t lo_count, std::uint64_t hi_count, double& z_lo, double& z_hi)
+{
+    // classe b = altitudes arrondies au niveau b, soit [b - 0.5, b + 0.5] pas
+    const double step = (zmax - zmin) / (double)(hist.size() - 1);
+    auto at_rank = [&](std::uint64_t r) {
+        std::uint64_t acc = 0;
+        for (std::size_t b = 0; b < hist.size(); ++b) {
+            if (acc + hist[b] > r) {
+                const double f = ((double)(r - acc) + 0.5) / (double)hist[b];
+                return std::clamp(zmin + ((double)b - 0.5 + f) * step, zmin, zmax);
+            }
+            acc += hist[b];
+        }
+        return zmax;
+    };
+    z_lo = at_rank(lo_count);
+    z_hi = at_rank(hi_count);
+}
+
+ColorStretch::Result ColorStretch::compute(const std::vector<double>& z, const std::vector<std::uint8_t>& mask, double zmin, double zmax, Mode mode, double clip_pct)
+{
+    MNT_PROFILE_ZONE("etirement");
+    Result res{zmin, zmax, identity()};
+    if (mode == Mode::Linear || !(zmax > zmin)) return res;
+
+    // 1) histogramme fin sur la plage brute : un point aberrant n'y occupe
+    // qu'une classe sans réduire la résolution sur le reste des altitudes
+    const auto fine = histogram(z, mask, zmin, zmax, FINE_LEVELS);
+
+    std::uint64_t total = 0;
+    for (auto c : fine) total += c;
+    if (total == 0) return res;
+
+    // Percentile : plage écrêtée aux rangs clip_pct % et (100 - clip_pct) %.
+    // Égalisation : seuls les rangs sous 1 / Z_LEVELS de chaque côté, qui
+    // tomberaient de toute façon dans le premier ou le dernier niveau, sont écrêtés
+    const double clip = (mode == Mode::Percentile) ? std::clamp(clip_pct, 0.0, 49.0) / 100.0 : 1.0 / (double)HaxbyColorMap::Z_LEVELS;
+    const std::uint64_t lo_count = (std::uint64_t)std::floor(clip * (double)total);
+    double z_lo, z_hi;
+    rank_range(fine, zmin, zmax, lo_count, total - 1 - lo_count, z_lo, z_hi);
+    if (!(z_hi > z_lo)) return res;
+
+    // le noyau quantifie directement sur [z_lo, z_hi] : Z_LEVELS niveaux utiles
+    res.zmin = z_lo;
+    res.zmax = z_hi;
+    if (mode == Mode::Percentile) return res;
+
+    // 2) Égalisation : fonction de répartition normalisée, sur la
+    // quantification du noyau dans la plage écrêtée
+    const std::size_t levels = HaxbyColorMap::Z_LEVELS;
+    const auto hist = histogram(z, mask, z_lo, z_hi, levels);
+    const double out_max = (double)(levels - 1);
+
+    std::uint64_t cdf_min = 0;
+    for (auto c : hist) { if (c) { cdf_min = c; break; } }
+    if (total == cdf_min) return res;
+
+    std::uint64_t acc = 0;
+    for (std::size_t b = 0; b < levels; ++b) {
+        acc += hist[b];
+        const double t = (acc <= cdf_min) ? 0.0 : (double)(acc - cdf_min) / (double)(total - cdf_min);
+        res.remap[b] = (std::uint16_t)std::lround(t * out_max);
+    }
+    return res;
+}
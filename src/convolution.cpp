@@ -0,0 +1,111 @@
+#include "convolution.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+// Largeur des blocs de colonnes de la passe verticale : (2r+1) segments
+// de BLOCK floats restent en cache d'une ligne de sortie à la suivante
+static constexpr std::size_t BLOCK = 512;
+
+std::vector<float> Convolution::gaussian_kernel(double sigma)
+{
+    const int radius = std::max(1, (int)std::ceil(3.0 * sigma));
+    const int size = 2 * radius + 1;
+    std::vector<double> k(size);
+
+    const double s2 = 2.0 * sigma * sigma;
+    double sum = 0.0;
+    for (int i = -radius; i <= radius; ++i) {
+        const double v = std::exp(-(i * i) / s2);
+        k[i + radius] = v;
+        sum += v;
+    }
+
+    std::vector<float> kf(size);
+    for (int i = 0; i < size; ++i) kf[i] = (float)(k[i] / sum);
+    return kf;
+}
+
+void Convolution::horizontal_row(const float* in, float* __restrict out, std::size_t w, const float* k, std::size_t r)
+{
+    const std::size_t ksize = 2 * r + 1;
+    const long last = (long)w - 1;
+
+    // bord gauche / droit : indices bornés
+    auto border = [&](std::size_t x) {
+        float acc = 0.0f;
+        for (std::size_t j = 0; j < ksize; ++j) {
+            const long xx = std::clamp((long)x + (long)j - (long)r, 0L, last);
+            acc += k[j] * in[xx];
+        }
+        out[x] = acc;
+    };
+
+    if (w <= 2 * r) {
+        for (std::size_t x = 0; x < w; ++x) border(x);
+        return;
+    }
+
+    for (std::size_t x = 0; x < r; ++x) border(x);
+    for (std::size_t x = w - r; x < w; ++x) border(x);
+
+    // intérieur : sans branche, contigu
+    const std::size_t n = w - 2 * r;
+    float* __restrict o = out + r;
+    for (std::size_t x = 0; x < n; ++x) o[x] = 0.0f;
+    for (std::size_t j = 0; j < ksize; ++j) {
+        const float kj = k[j];
+        const float* __restrict src = in + j;
+        for (std::size_t x = 0; x < n; ++x) o[x] += kj * src[x];
+    }
+}
+
+void Convolution::vertical_rows(const float* in, float* __restrict out, std::size_t w, std::size_t h, std::size_t y0, std::size_t y1, const float* k, std::size_t r)
+{
+    const std::size_t ksize = 2 * r + 1;
+    const long last = (long)h - 1;
+
+    for (std::size_t bx = 0; bx < w; bx += BLOCK) {
+        const std::size_t bw = std::min(BLOCK, w - bx);
+
+        for (std::size_t y = y0; y < y1; ++y) {
+            float* __restrict o = out + y * w + bx;
+            for (std::size_t x = 0; x < bw; ++x) o[x] = 0.0f;
+
+            // bornage des lignes sources hors de la boucle interne
+            for (std::size_t j = 0; j < ksize; ++j) {
+                const long yy = std::clamp((long)y + (long)j - (long)r, 0L, last);
+                const float kj = k[j];
+                const float* __restrict src = in + (std::size_t)yy * w + bx;
+                for (std::size_t x = 0; x < bw; ++x) o[x] += kj * src[x];
+            }
+        }
+    }
+}
+
+void Convolution::separable(std::vector<float>& img, std::size_t w, std::size_t h, const std::vector<float>& kernel)
+{
+    MNT_PROFILE_ZONE("convolution");
+    if (kernel.empty() || kernel.size() % 2 == 0)
+        throw std::runtime_error("Convolution: noyau de taille impaire attendu.");
+    if (img.size() != w * h)
+        throw std::runtime_error("Convolution: taille d'image incorrecte.");
+    if (w == 0 || h == 0) return;
+
+    const std::size_t r = kernel.size() / 2;
+    std::vector<float> tmp(w * h);
+
+    // horizontal : img -> tmp
+    parallel_for(0, h, [&](std::size_t y0, std::size_t y1) {
+        for (std::size_t y = y0; y < y1; ++y) {
+            horizontal_row(img.data() + y * w, tmp.data() + y * w, w, kernel.data(), r);
+        }
+    }, 16);
+
+    // vertical : tmp -> img
+    parallel_for(0, h, [&](std::size_t y0, std::size_t y1) {
+        vertical_rows(tmp.data(), img.data(), w, h, y0, y1, kernel.data(), r);
+    }, 16);
+}
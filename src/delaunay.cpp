@@ -0,0 +1,12 @@
+#include "delaunay.hpp"
+#include "delaunator.hpp"
+#include "profiler.hpp"
+
+std::vector<std::size_t> Delaunay::triangulate(const std::vector<double>& coords, std::vector<std::size_t>* halfedges)
+{
+    MNT_PROFILE_ZONE("delaunay");
+    static_assert(NO_EDGE == delaunator::INVALID_INDEX, "NO_EDGE doit valoir delaunator::INVALID_INDEX");
+    delaunator::Delaunator d(coords);
+    if (halfedges) *halfedges = std::move(d.halfedges);
+    return std::move(d.triangles);
+}
@@ -0,0 +1,167 @@
+#include "fft.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+FFT2D::FFT2D(std::size_t w, std::size_t h) : m_w(w), m_h(h)
+{
+    if (w < 2 || h < 1 || !is_pow2(w) || !is_pow2(h))
+        throw std::runtime_error("FFT2D: dimensions non puissances de 2.");
+
+    m_row = make_plan(w / 2);
+    m_col = make_plan(h);
+
+    const double pi = 3.14159265358979323846;
+    m_split.resize(w / 2 + 1);
+    for (std::size_t k = 0; k <= w / 2; ++k) {
+        const double a = -2.0 * pi * (double)k / (double)w;
+        m_split[k] = cplx(std::cos(a), std::sin(a));
+    }
+}
+
+bool FFT2D::is_pow2(std::size_t v)
+{
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+FFT2D::Plan FFT2D::make_plan(std::size_t n)
+{
+    Plan p;
+    p.n = n;
+
+    const double pi = 3.14159265358979323846;
+    p.tw.resize(n / 2);
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        const double a = -2.0 * pi * (double)k / (double)n;
+        p.tw[k] = cplx(std::cos(a), std::sin(a));
+    }
+
+    std::size_t bits = 0;
+    while (((std::size_t)1 << bits) < n) ++bits;
+    p.rev.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < bits; ++b) {
+            if (i & ((std::size_t)1 << b)) r |= (std::size_t)1 << (bits - 1 - b);
+        }
+        p.rev[i] = r;
+    }
+    return p;
+}
+
+void FFT2D::fft1d(cplx* a, const Plan& p, bool inverse)
+{
+    const std::size_t n = p.n;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t j = p.rev[i];
+        if (i < j) std::swap(a[i], a[j]);
+    }
+
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const std::size_t half = len / 2;
+        const std::size_t step = n / len;
+        for (std::size_t i = 0; i < n; i += len) {
+            for (std::size_t k = 0; k < half; ++k) {
+                const cplx w = inverse ? std::conj(p.tw[k * step]) : p.tw[k * step];
+                const cplx u = a[i + k];
+                const cplx v = a[i + k + half] * w;
+                a[i + k] = u + v;
+                a[i + k + half] = u - v;
+            }
+        }
+    }
+
+    if (inverse) {
+        const double s = 1.0 / (double)n;
+        for (std::size_t i = 0; i < n; ++i) a[i] *= s;
+    }
+}
+
+void FFT2D::row_forward(const double* in, cplx* out, cplx* work) const
+{
+    const std::size_t n2 = m_w / 2;
+    for (std::size_t k = 0; k < n2; ++k) work[k] = cplx(in[2 * k], in[2 * k + 1]);
+    fft1d(work, m_row, false);
+
+    // séparation des spectres pairs / impairs
+    for (std::size_t k = 0; k <= n2; ++k) {
+        const cplx zk = work[k % n2];
+        const cplx zc = std::conj(work[(n2 - k) % n2]);
+        const cplx fe = 0.5 * (zk + zc);
+        const cplx fo = cplx(0.0, -0.5) * (zk - zc);
+        out[k] = fe + m_split[k] * fo;
+    }
+}
+
+void FFT2D::row_inverse(const cplx* in, double* out, cplx* work) const
+{
+    const std::size_t n2 = m_w / 2;
+    for (std::size_t k = 0; k < n2; ++k) {
+        const cplx xk = in[k];
+        const cplx xc = std::conj(in[n2 - k]);
+        const cplx fe = 0.5 * (xk + xc);
+        const cplx fo = 0.5 * (xk - xc) * std::conj(m_split[k]);
+        work[k] = fe + cplx(0.0, 1.0) * fo;
+    }
+    fft1d(work, m_row, true);
+
+    for (std::size_t k = 0; k < n2; ++k) {
+        out[2 * k] = work[k].real();
+        out[2 * k + 1] = work[k].imag();
+    }
+}
+
+void FFT2D::forward(const std::vector<double>& in, std::vector<cplx>& spec) const
+{
+    MNT_PROFILE_ZONE("fft_forward");
+    if (in.size() != m_w * m_h) throw std::runtime_error("FFT2D: taille d'entrée incorrecte.");
+
+    const std::size_t sw = spec_width();
+    spec.resize(m_h * sw);
+
+    // lignes (réelles)
+    parallel_for(0, m_h, [&](std::size_t y0, std::size_t y1) {
+        std::vector<cplx> work(m_w / 2);
+        for (std::size_t y = y0; y < y1; ++y) {
+            row_forward(in.data() + y * m_w, spec.data() + y * sw, work.data());
+        }
+    }, 8);
+
+    // colonnes (complexes) : copie contiguë de chaque colonne
+    parallel_for(0, sw, [&](std::size_t x0, std::size_t x1) {
+        std::vector<cplx> col(m_h);
+        for (std::size_t x = x0; x < x1; ++x) {
+            for (std::size_t y = 0; y < m_h; ++y) col[y] = spec[y * sw + x];
+            fft1d(col.data(), m_col, false);
+            for (std::size_t y = 0; y < m_h; ++y) spec[y * sw + x] = col[y];
+        }
+    }, 8);
+}
+
+void FFT2D::inverse(std::vector<cplx>& spec, std::vector<double>& out) const
+{
+    MNT_PROFILE_ZONE("fft_inverse");
+    const std::size_t sw = spec_width();
+    if (spec.size() != m_h * sw) throw std::runtime_error("FFT2D: taille de spectre incorrecte.");
+
+    out.resize(m_w * m_h);
+
+    parallel_for(0, sw, [&](std::size_t x0, std::size_t x1) {
+        std::vector<cplx> col(m_h);
+        for (std::size_t x = x0; x < x1; ++x) {
+            for (std::size_t y = 0; y < m_h; ++y) col[y] = spec[y * sw + x];
+            fft1d(col.data(), m_col, true);
+            for (std::size_t y = 0; y < m_h; ++y) spec[y * sw + x] = col[y];
+        }
+    }, 8);
+
+    parallel_for(0, m_h, [&](std::size_t y0, std::size_t y1) {
+        std::vector<cplx> work(m_w / 2);
+        for (std::size_t y = y0; y < y1; ++y) {
+            row_inverse(spec.data() + y * sw, out.data() + y * m_w, work.data());
+        }
+    }, 8);
+}
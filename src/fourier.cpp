@@ -2,7 +2,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include "convolution.hpp"
+#include "fft.hpp"
+#include "profiler.hpp"
 
 FourierPreprocess::FourierPreprocess(Params p) : m_p(p) {}
 
@@ -31,129 +35,225 @@ void FourierPreprocess::compute_grid_dims(std::size_t target_width, const BBox2D
     }
 }
 
-static std::vector<double> gaussian_kernel(double sigma){
-    const int radius = std::max(1, (int)std::ceil(3.0 * sigma));
-    const int size = 2 * radius + 1;
-    std::vector<double> k(size);
+void FourierPreprocess::bin_average(const std::vector<Point3D>& pts, const BBox2D& bb, std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask){
+    PointBinner::Result r = PointBinner::bin(pts, bb, gw, gh, PointBinner::MEAN);
 
-    const double s2 = 2.0 * sigma * sigma;
-    double sum = 0.0;
-    for (int i = -radius; i <= radius; ++i) {
-        const double v = std::exp(-(i * i) / s2);
-        k[i + radius] = v;
-        sum += v;
+    z = std::move(r.mean);
+    mask.assign(gw * gh, CELL_EMPTY);
+    for (std::size_t id = 0; id < gw * gh; ++id) {
+        if (r.count[id] > 0) mask[id] = CELL_MEASURED;
     }
-    for (double& v : k) v /= sum;
-    return k;
 }
 
-void FourierPreprocess::bin_average(const std::vector<Point3D>& pts, const BBox2D& bb, std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask){
-    z.assign(gw * gh, 0.0);
-    mask.assign(gw * gh, 0);
-
-    std::vector<double> sum(gw * gh, 0.0);
-    std::vector<std::size_t> cnt(gw * gh, 0);
-
-    const double bw = bb.maxx - bb.minx;
-    const double bh = bb.maxy - bb.miny;
-
-    for (const auto& p : pts) {
-        const double tx = (p.x - bb.minx) / bw;
-        const double ty = (bb.maxy - p.y) / bh; // y inversé
-        if (tx < 0.0 || tx >= 1.0 || ty < 0.0 || ty >= 1.0) continue;
+std::vector<std::uint32_t> FourierPreprocess::distance_to_measured(std::size_t gw, std::size_t gh, const std::vector<std::uint8_t>& mask){
+    const std::uint32_t inf = std::numeric_limits<std::uint32_t>::max() / 2;
+    std::vector<std::uint32_t> d(gw * gh);
+    for (std::size_t id = 0; id < gw * gh; ++id) d[id] = (mask[id] == CELL_MEASURED) ? 0 : inf;
 
-        const std::size_t ix = std::min<std::size_t>(gw - 1, (std::size_t)std::floor(tx * (double)gw));
-        const std::size_t iy = std::min<std::size_t>(gh - 1, (std::size_t)std::floor(ty * (double)gh));
-        const std::size_t id = iy * gw + ix;
-
-        sum[id] += p.z;
-        cnt[id] += 1;
+    // passe avant (voisins haut / gauche) puis arrière (bas / droite), 8-connexité
+    for (std::size_t y = 0; y < gh; ++y) {
+        for (std::size_t x = 0; x < gw; ++x) {
+            std::uint32_t v = d[y * gw + x];
+            if (x > 0) v = std::min(v, d[y * gw + x - 1] + 1);
+            if (y > 0) {
+                const std::uint32_t* up = &d[(y - 1) * gw];
+                v = std::min(v, up[x] + 1);
+                if (x > 0) v = std::min(v, up[x - 1] + 1);
+                if (x + 1 < gw) v = std::min(v, up[x + 1] + 1);
+            }
+            d[y * gw + x] = v;
+        }
     }
-
-    for (std::size_t id = 0; id < gw * gh; ++id) {
-        if (cnt[id] > 0) {
-            z[id] = sum[id] / (double)cnt[id];
-            mask[id] = 1;
+    for (std::size_t y = gh; y-- > 0;) {
+        for (std::size_t x = gw; x-- > 0;) {
+            std::uint32_t v = d[y * gw + x];
+            if (x + 1 < gw) v = std::min(v, d[y * gw + x + 1] + 1);
+            if (y + 1 < gh) {
+                const std::uint32_t* dn = &d[(y + 1) * gw];
+                v = std::min(v, dn[x] + 1);
+                if (x > 0) v = std::min(v, dn[x - 1] + 1);
+                if (x + 1 < gw) v = std::min(v, dn[x + 1] + 1);
+            }
+            d[y * gw + x] = v;
         }
     }
+    return d;
 }
 
-void FourierPreprocess::fill_missing(std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask, int iters){
-    if (iters <= 0) return;
+std::size_t FourierPreprocess::fill_missing(std::size_t gw, std::size_t gh, std::vector<double>& z, std::vector<std::uint8_t>& mask, int max_dist){
+    MNT_PROFILE_ZONE("remplissage");
+    if (max_dist == 0 || gw == 0 || gh == 0) return 0;
+
+    // Niveau de pyramide : valeur moyenne pondérée + poids de confiance dans [0,1]
+    struct Level {
+        std::size_t w, h;
+        std::vector<double> v;
+        std::vector<float> wt;
+    };
+
+    std::vector<Level> pyr;
+    pyr.push_back({gw, gh, z, std::vector<float>(gw * gh)});
+    for (std::size_t id = 0; id < gw * gh; ++id) pyr[0].wt[id] = (mask[id] == CELL_MEASURED) ? 1.0f : 0.0f;
+
+    // Pull : réduction 2x2 jusqu'à une seule cellule (mémoire totale ~ 4/3 de la grille)
+    while (pyr.back().w > 1 || pyr.back().h > 1) {
+        const Level& f = pyr.back();
+        Level c;
+        c.w = (f.w + 1) / 2;
+        c.h = (f.h + 1) / 2;
+        c.v.assign(c.w * c.h, 0.0);
+        c.wt.assign(c.w * c.h, 0.0f);
+
+        for (std::size_t y = 0; y < c.h; ++y) {
+            for (std::size_t x = 0; x < c.w; ++x) {
+                double vs = 0.0, ws = 0.0;
+                for (std::size_t sy = 2 * y; sy < std::min(f.h, 2 * y + 2); ++sy) {
+                    for (std::size_t sx = 2 * x; sx < std::min(f.w, 2 * x + 2); ++sx) {
+                        const std::size_t k = sy * f.w + sx;
+                        vs += f.wt[k] * f.v[k];
+                        ws += f.wt[k];
+                    }
+                }
+                c.v[y * c.w + x] = (ws > 0.0) ? vs / ws : 0.0;
+                c.wt[y * c.w + x] = (float)std::min(1.0, ws);
+            }
+        }
+        pyr.push_back(std::move(c));
+    }
+
+    if (pyr.back().wt[0] <= 0.0f) return 0; // aucune donnée
 
-    for (int k = 0; k < iters; ++k) {
-        auto z2 = z;
-        auto m2 = mask;
+    // Push : chaque niveau complète ses cellules peu fiables par le niveau plus grossier
+    for (std::size_t l = pyr.size() - 1; l-- > 0;) {
+        Level& f = pyr[l];
+        const Level& c = pyr[l + 1];
 
-        for (std::size_t y = 0; y < gh; ++y) {
-            for (std::size_t x = 0; x < gw; ++x) {
-                const std::size_t id = y * gw + x;
-                if (mask[id]) continue;
+        for (std::size_t y = 0; y < f.h; ++y) {
+            // centre de la cellule fine dans le repère des cellules grossières
+            const double cy = std::clamp(((double)y + 0.5) * 0.5 - 0.5, 0.0, (double)(c.h - 1));
+            const std::size_t y0 = (std::size_t)cy;
+            const std::size_t y1 = std::min(y0 + 1, c.h - 1);
+            const double ty = cy - (double)y0;
 
-                double acc = 0.0;
-                int n = 0;
-                for (int dy = -1; dy <= 1; ++dy) {
-                    for (int dx = -1; dx <= 1; ++dx) {
-                        if (dx == 0 && dy == 0) continue;
-                        const long xx = (long)x + dx;
-                        const long yy = (long)y + dy;
-                        if (xx < 0 || yy < 0 || xx >= (long)gw || yy >= (long)gh) continue;
-                        const std::size_t jd = (std::size_t)yy * gw + (std::size_t)xx;
-                        if (!mask[jd]) continue;
-                        acc += z[jd];
-                        n++;
-                    }
-                }
-                if (n > 0) {
-                    z2[id] = acc / (double)n;
-                    m2[id] = 1;
-                }
+            for (std::size_t x = 0; x < f.w; ++x) {
+                const std::size_t k = y * f.w + x;
+                const double w = f.wt[k];
+                if (w >= 1.0) continue;
+
+                const double cx = std::clamp(((double)x + 0.5) * 0.5 - 0.5, 0.0, (double)(c.w - 1));
+                const std::size_t x0 = (std::size_t)cx;
+                const std::size_t x1 = std::min(x0 + 1, c.w - 1);
+                const double tx = cx - (double)x0;
+
+                const double top = (1.0 - tx) * c.v[y0 * c.w + x0] + tx * c.v[y0 * c.w + x1];
+                const double bot = (1.0 - tx) * c.v[y1 * c.w + x0] + tx * c.v[y1 * c.w + x1];
+                const double coarse = (1.0 - ty) * top + ty * bot;
+
+                f.v[k] = w * f.v[k] + (1.0 - w) * coarse;
             }
         }
+    }
 
-        z.swap(z2);
-        mask.swap(m2);
+    // Report sur la grille, limité à max_dist cellules des mesures
+    const auto dist = distance_to_measured(gw, gh, mask);
+    const std::uint32_t limit = (max_dist < 0) ? std::numeric_limits<std::uint32_t>::max() : (std::uint32_t)max_dist;
+
+    std::size_t filled = 0;
+    for (std::size_t id = 0; id < gw * gh; ++id) {
+        if (mask[id] == CELL_MEASURED) continue;
+        if (dist[id] > limit) continue;
+        z[id] = pyr[0].v[id];
+        mask[id] = CELL_FILLED;
+        filled++;
     }
+    return filled;
 }
 
 void FourierPreprocess::gaussian_separable(std::size_t gw, std::size_t gh, std::vector<double>& z, double sigma_px){
+    MNT_PROFILE_ZONE("filtre_spatial");
     if (sigma_px <= 0.0) return;
 
-    auto k = gaussian_kernel(sigma_px);
-    const int radius = (int)k.size() / 2;
+    // float32 : deux fois plus de valeurs par registre SIMD et par ligne de cache
+    std::vector<float> zf(z.begin(), z.end());
+    Convolution::separable(zf, gw, gh, Convolution::gaussian_kernel(sigma_px));
+    std::copy(zf.begin(), zf.end(), z.begin());
+}
 
-    std::vector<double> tmp(gw * gh, 0.0);
+std::size_t FourierPreprocess::fft_padding(const Params& p){
+    // portée du noyau : 3 sigma (gaussien) ; Butterworth, réponse plus étalée : 2 / fc
+    if (p.filter == Filter::Butterworth) return (std::size_t)std::ceil(2.0 / std::max(1e-6, p.cutoff));
+    return (std::size_t)std::max(1.0, std::ceil(3.0 * p.sigma_px));
+}
 
-    // horizontal
-    for (std::size_t y = 0; y < gh; ++y) {
-        for (std::size_t x = 0; x < gw; ++x) {
-            double acc = 0.0;
-            for (int dx = -radius; dx <= radius; ++dx) {
-                long xx = (long)x + dx;
-                if (xx < 0) xx = 0;
-                if (xx >= (long)gw) xx = (long)gw - 1;
-                acc += k[dx + radius] * z[y * gw + (std::size_t)xx];
+bool FourierPreprocess::use_frequency_domain(std::size_t gw, std::size_t gh, const Params& p){
+    if (p.filter == Filter::Butterworth || p.domain == Domain::Frequency) return true;
+    if (p.domain == Domain::Spatial || p.sigma_px <= 0.0) return false;
+
+    // coût par cellule : noyau séparable (2 passes de 2r+1 produits)
+    // contre FFT aller + retour (~2.5 opérations par niveau de log2) sur la grille bordée
+    const std::size_t pad = fft_padding(p);
+    const std::size_t pw = next_pow2(gw + 2 * pad), ph = next_pow2(gh + 2 * pad);
+    const double radius = std::max(1.0, std::ceil(3.0 * p.sigma_px));
+    const double spatial = 2.0 * (2.0 * radius + 1.0);
+    const double freq = 2.0 * 2.5 * (std::log2((double)pw) + std::log2((double)ph)) * (double)(pw * ph) / (double)(gw * gh);
+    return freq < spatial;
+}
+
+void FourierPreprocess::lowpass_fft(std::size_t gw, std::size_t gh, std::vector<double>& z, const Params& p){
+    MNT_PROFILE_ZONE("filtre_fft");
+
+    // La FFT filtre une grille périodique : bordure d'au moins la portée du
+    // noyau, bords répliqués (comme Convolution::separable), puis recadrage.
+    // Les bords opposés ne se mélangent plus et le résultat aux bords est
+    // celui du filtrage spatial.
+    const std::size_t pad = fft_padding(p);
+    const std::size_t pw = next_pow2(gw + 2 * pad), ph = next_pow2(gh + 2 * pad);
+    const std::size_t ox = (pw - gw) / 2, oy = (ph - gh) / 2;
+    std::vector<double> zp(pw * ph);
+    for (std::size_t y = 0; y < ph; ++y) {
+        const std::size_t sy = (std::size_t)std::clamp((long)y - (long)oy, 0L, (long)gh - 1);
+        const double* row = z.data() + sy * gw;
+        double* out = zp.data() + y * pw;
+        std::fill(out, out + ox, row[0]);
+        std::copy(row, row + gw, out + ox);
+        std::fill(out + ox + gw, out + pw, row[gw - 1]);
+    }
+
+    FFT2D fft(pw, ph);
+    std::vector<FFT2D::cplx> spec;
+    fft.forward(zp, spec);
+
+    const double pi = 3.14159265358979323846;
+    const std::size_t sw = fft.spec_width();
+    const double two_pi2_s2 = 2.0 * pi * pi * p.sigma_px * p.sigma_px;
+    const double fc = std::max(1e-6, p.cutoff);
+    const int order = std::max(1, p.butterworth_order);
+
+    for (std::size_t ky = 0; ky < ph; ++ky) {
+        // fréquences en cycles/cellule, ky > ph/2 -> négatives
+        const double fy = (ky <= ph / 2 ? (double)ky : (double)ky - (double)ph) / (double)ph;
+        for (std::size_t kx = 0; kx < sw; ++kx) {
+            const double fx = (double)kx / (double)pw;
+            const double f2 = fx * fx + fy * fy;
+
+            double H;
+            if (p.filter == Filter::Butterworth) {
+                H = 1.0 / (1.0 + std::pow(f2 / (fc * fc), (double)order));
+            } else {
+                H = std::exp(-two_pi2_s2 * f2);
             }
-            tmp[y * gw + x] = acc;
+            spec[ky * sw + kx] *= H;
         }
     }
 
-    // vertical
+    fft.inverse(spec, zp);
     for (std::size_t y = 0; y < gh; ++y) {
-        for (std::size_t x = 0; x < gw; ++x) {
-            double acc = 0.0;
-            for (int dy = -radius; dy <= radius; ++dy) {
-                long yy = (long)y + dy;
-                if (yy < 0) yy = 0;
-                if (yy >= (long)gh) yy = (long)gh - 1;
-                acc += k[dy + radius] * tmp[(std::size_t)yy * gw + x];
-            }
-            z[y * gw + x] = acc;
-        }
+        std::copy_n(zp.data() + (y + oy) * pw + ox, gw, z.data() + y * gw);
     }
 }
 
-std::vector<Point3D> FourierPreprocess::sample_regular(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t step){
+std::vector<Point3D> FourierPreprocess::sample_regular(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, std::size_t step, bool keep_filled){
+    MNT_PROFILE_ZONE("echantillonnage");
     if (step == 0) step = 1;
 
     const double bw = bb.maxx - bb.minx;
@@ -170,6 +270,7 @@ std::vector<Point3D> FourierPreprocess::sample_regular(const BBox2D& bb, std::si
         for (std::size_t x = 0; x < gw; x += step) {
             const std::size_t id = y * gw + x;
             if (!mask[id]) continue;
+            if (!keep_filled && mask[id] == CELL_FILLED) continue;
 
             const double wx = bb.minx + (double(x) + 0.5) * dx;
             out.push_back({wx, wy, z[id]});
@@ -178,28 +279,135 @@ std::vector<Point3D> FourierPreprocess::sample_regular(const BBox2D& bb, std::si
     return out;
 }
 
-std::vector<Point3D> FourierPreprocess::run(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t target_width_px) const{
+std::vector<Point3D> FourierPreprocess::sample_adaptive(const BBox2D& bb, std::size_t gw, std::size_t gh, const std::vector<double>& z, const std::vector<std::uint8_t>& mask, const Params& p){
+    MNT_PROFILE_ZONE("echantillonnage_adaptatif");
+    const std::size_t step = std::max<std::size_t>(1, p.sample_step);
+    const int levels = std::clamp(p.adaptive_levels, 0, 16);
+
+    const double dx = (bb.maxx - bb.minx) / (double)gw;
+    const double dy = (bb.maxy - bb.miny) / (double)gh;
+
+    auto valid = [&](std::size_t id) {
+        return mask[id] && (p.keep_filled || mask[id] != CELL_FILLED);
+    };
+
+    // Candidats : réseau au pas `step`, niveau = nb de facteurs 2 communs (plafonné)
+    struct Candidate {
+        std::size_t id;
+        double err;
+    };
+    std::vector<std::size_t> keep;
+    std::vector<Candidate> cand;
+
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for (std::size_t y = 0, j = 0; y < gh; y += step, ++j) {
+        for (std::size_t x = 0, i = 0; x < gw; x += step, ++i) {
+            const std::size_t id = y * gw + x;
+            if (!valid(id)) continue;
+
+            int lvl = 0;
+            while (lvl < levels && ((i | j) & ((std::size_t)1 << lvl)) == 0) ++lvl;
+            if (lvl == levels) {
+                keep.push_back(id); // squelette grossier
+                continue;
+            }
+
+            // voisines du niveau supérieur à distance d (axe(s) sur lesquels la cellule est impaire)
+            const std::size_t d = step << lvl;
+            const bool odd_x = (i >> lvl) & 1;
+            const bool odd_y = (j >> lvl) & 1;
+
+            double err = inf; // bord du domaine ou voisine invalide : point conservé
+            if (x >= d && y >= d && x + d < gw && y + d < gh) {
+                std::size_t nb[4];
+                std::size_t n = 0;
+                if (odd_x && odd_y) {
+                    nb[n++] = (y - d) * gw + (x - d); nb[n++] = (y - d) * gw + (x + d);
+                    nb[n++] = (y + d) * gw + (x - d); nb[n++] = (y + d) * gw + (x + d);
+                } else if (odd_x) {
+                    nb[n++] = y * gw + (x - d); nb[n++] = y * gw + (x + d);
+                } else {
+                    nb[n++] = (y - d) * gw + x; nb[n++] = (y + d) * gw + x;
+                }
+
+                bool ok = true;
+                double acc = 0.0;
+                for (std::size_t k = 0; k < n; ++k) {
+                    if (!valid(nb[k])) { ok = false; break; }
+                    acc += z[nb[k]];
+                }
+                if (ok) err = std::abs(z[id] - acc / (double)n);
+            }
+            cand.push_back({id, err});
+        }
+    }
+
+    if (p.point_budget > 0) {
+        // les `budget - squelette` candidats de plus grande erreur
+        const std::size_t room = (p.point_budget > keep.size()) ? p.point_budget - keep.size() : 0;
+        if (room < cand.size()) {
+            std::nth_element(cand.begin(), cand.begin() + (std::ptrdiff_t)room, cand.end(),
+                             [](const Candidate& a, const Candidate& b){ return a.err > b.err; });
+            cand.resize(room);
+        }
+        for (const auto& c : cand) keep.push_back(c.id);
+    } else {
+        for (const auto& c : cand) {
+            if (c.err > p.max_error) keep.push_back(c.id);
+        }
+    }
+
+    std::sort(keep.begin(), keep.end());
+
+    std::vector<Point3D> out;
+    out.reserve(keep.size());
+    for (std::size_t id : keep) {
+        const std::size_t x = id % gw;
+        const std::size_t y = id / gw;
+        out.push_back({bb.minx + (double(x) + 0.5) * dx, bb.maxy - (double(y) + 0.5) * dy, z[id]});
+    }
+    return out;
+}
+
+FilteredGrid FourierPreprocess::run_grid(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t target_width_px) const{
+    MNT_PROFILE_ZONE("fourier");
     if (target_width_px == 0) throw std::runtime_error("FourierPreprocess: width == 0");
 
-    std::size_t gw = 0, gh = 0;
-    compute_grid_dims(target_width_px, bbox, m_p.grid_scale, m_p.pow2_grid, gw, gh);
+    FilteredGrid g;
+    g.bbox = bbox;
+    compute_grid_dims(target_width_px, bbox, m_p.grid_scale, m_p.pow2_grid, g.gw, g.gh);
 
     const double bw = bbox.maxx - bbox.minx;
     const double bh = bbox.maxy - bbox.miny;
 
-    m_last.gw = gw;
-    m_last.gh = gh;
-    m_last.dx = bw / (double)gw;
-    m_last.dy = bh / (double)gh;
+    m_last.gw = g.gw;
+    m_last.gh = g.gh;
+    m_last.dx = bw / (double)g.gw;
+    m_last.dy = bh / (double)g.gh;
 
-    std::vector<double> z;
-    std::vector<std::uint8_t> mask;
+    bin_average(pts, bbox, g.gw, g.gh, g.z, g.mask);
 
-    bin_average(pts, bbox, gw, gh, z, mask);
+    m_last.filled = fill_missing(g.gw, g.gh, g.z, g.mask, m_p.fill_iters);
 
-    fill_missing(gw, gh, z, mask, m_p.fill_iters);
+    m_last.frequency_domain = use_frequency_domain(g.gw, g.gh, m_p);
+    if (m_last.frequency_domain) {
+        lowpass_fft(g.gw, g.gh, g.z, m_p);
+    } else {
+        gaussian_separable(g.gw, g.gh, g.z, m_p.sigma_px);
+    }
 
-    gaussian_separable(gw, gh, z, m_p.sigma_px);
+    if (!m_p.keep_filled) {
+        for (auto& m : g.mask) {
+            if (m == CELL_FILLED) m = CELL_EMPTY;
+        }
+    }
+    return g;
+}
+
+std::vector<Point3D> FourierPreprocess::run(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t target_width_px) const{
+    const FilteredGrid g = run_grid(pts, bbox, target_width_px);
 
-    return sample_regular(bbox, gw, gh, z, mask, m_p.sample_step);
+    if (m_p.sampling == Sampling::Adaptive) return sample_adaptive(bbox, g.gw, g.gh, g.z, g.mask, m_p);
+    return sample_regular(bbox, g.gw, g.gh, g.z, g.mask, m_p.sample_step, m_p.keep_filled);
 }
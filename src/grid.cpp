@@ -1,9 +1,42 @@
 #include "grid.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include "profiler.hpp"
 
-Grid::Grid(const Mesh2D& mesh, BBox2D bbox, std::size_t nx, std::size_t ny): m_mesh(mesh), m_bbox(bbox), m_nx(nx), m_ny(ny)
+Grid::Grid(const Mesh2D& mesh, BBox2D bbox, std::size_t nx, std::size_t ny, Overlap overlap): m_mesh(mesh), m_bbox(bbox), m_nx(nx), m_ny(ny), m_overlap(overlap)
 {
+    MNT_PROFILE_ZONE("Grid");
+    init_steps();
+    m_cells.resize(m_nx * m_ny);
+
+    // Insertion triangles
+    for (std::size_t ti = 0; ti < m_mesh.triangle_count(); ++ti) insert(ti);
+
+    if (Profiler::enabled()) {
+        // occupation des cellules : 0, 1, 2-3, 4-7, ... triangles
+        std::vector<std::uint64_t> buckets;
+        for (const auto& c : m_cells) {
+            std::size_t b = 0;
+            while (((std::size_t)1 << b) <= c.size()) ++b;
+            if (buckets.size() <= b) buckets.resize(b + 1, 0);
+            buckets[b]++;
+        }
+        std::vector<std::string> labels;
+        for (std::size_t b = 0; b < buckets.size(); ++b) {
+            if (b < 2) labels.push_back(std::to_string(b));
+            else labels.push_back(std::to_string((std::size_t)1 << (b - 1)) + "-" + std::to_string(((std::size_t)1 << b) - 1));
+        }
+        Profiler::histogram("grid_occupation", buckets, labels);
+
+        std::uint64_t entries = 0;
+        for (const auto& c : m_cells) entries += c.size();
+        Profiler::add(Profiler::Counter::GridTriangles, m_mesh.triangle_count());
+        Profiler::add(Profiler::Counter::GridEntries, entries);
+    }
+}
+
+void Grid::init_steps() {
     if (m_nx < 1) m_nx = 1;
     if (m_ny < 1) m_ny = 1;
 
@@ -13,28 +46,90 @@ Grid::Grid(const Mesh2D& mesh, BBox2D bbox, std::size_t nx, std::size_t ny): m_m
     // éviter division par zéro
     if (m_dx <= 0) m_dx = 1.0;
     if (m_dy <= 0) m_dy = 1.0;
+}
 
-    m_cells.resize(m_nx * m_ny);
-
-    // Insertion triangles
-    for (std::size_t ti = 0; ti < m_mesh.triangle_count(); ++ti) {
-        const BBox2D tb = m_mesh.triangle_bbox(ti);
+void Grid::cell_range(const BBox2D& tb, std::size_t& cx0, std::size_t& cx1, std::size_t& cy0, std::size_t& cy1) const {
+    const long ix0 = static_cast<long>(std::floor((tb.minx - m_bbox.minx) / m_dx));
+    const long ix1 = static_cast<long>(std::floor((tb.maxx - m_bbox.minx) / m_dx));
+    const long iy0 = static_cast<long>(std::floor((tb.miny - m_bbox.miny) / m_dy));
+    const long iy1 = static_cast<long>(std::floor((tb.maxy - m_bbox.miny) / m_dy));
 
-        const long ix0 = static_cast<long>(std::floor((tb.minx - m_bbox.minx) / m_dx));
-        const long ix1 = static_cast<long>(std::floor((tb.maxx - m_bbox.minx) / m_dx));
-        const long iy0 = static_cast<long>(std::floor((tb.miny - m_bbox.miny) / m_dy));
-        const long iy1 = static_cast<long>(std::floor((tb.maxy - m_bbox.miny) / m_dy));
+    cx0 = clamp_index(ix0, m_nx);
+    cx1 = clamp_index(ix1, m_nx);
+    cy0 = clamp_index(iy0, m_ny);
+    cy1 = clamp_index(iy1, m_ny);
+}
 
-        const std::size_t cx0 = clamp_index(ix0, m_nx);
-        const std::size_t cx1 = clamp_index(ix1, m_nx);
-        const std::size_t cy0 = clamp_index(iy0, m_ny);
-        const std::size_t cy1 = clamp_index(iy1, m_ny);
+void Grid::insert(std::size_t ti) {
+    std::size_t cx0, cx1, cy0, cy1;
+    cell_range(m_mesh.triangle_bbox(ti), cx0, cx1, cy0, cy1);
 
+    // une seule ligne ou colonne : la bbox est déjà exacte
+    if (m_overlap == Overlap::BBox || cx0 == cx1 || cy0 == cy1) {
         for (std::size_t cy = cy0; cy <= cy1; ++cy) {
             for (std::size_t cx = cx0; cx <= cx1; ++cx) {
                 m_cells[cell_index(cx, cy)].push_back(ti);
             }
         }
+        return;
+    }
+
+    // Sommets triés en y : la section du triangle à l'ordonnée y va de l'arête
+    // longue (a, c) à l'arête courte (a, b) ou (b, c) ; son étendue sur une
+    // ligne de cellules est celle des sections aux deux bords de la ligne et
+    // au sommet b s'il y tombe (bords linéaires entre deux sommets)
+    std::size_t ia, ib, ic;
+    m_mesh.triangle_indices(ti, ia, ib, ic);
+    Vec2 a = m_mesh.vertex(ia), b = m_mesh.vertex(ib), c = m_mesh.vertex(ic);
+    if (a.y > b.y) std::swap(a, b);
+    if (b.y > c.y) std::swap(b, c);
+    if (a.y > b.y) std::swap(a, b);
+
+    const double sac = c.y > a.y ? (c.x - a.x) / (c.y - a.y) : 0.0;
+    const double sab = b.y > a.y ? (b.x - a.x) / (b.y - a.y) : 0.0;
+    const double sbc = c.y > b.y ? (c.x - b.x) / (c.y - b.y) : 0.0;
+    auto section = [&](double y, double& lo, double& hi) {
+        y = std::clamp(y, a.y, c.y);
+        const double x1 = a.x + (y - a.y) * sac;
+        const double x2 = y < b.y ? a.x + (y - a.y) * sab : b.x + (y - b.y) * sbc;
+        lo = std::min(lo, std::min(x1, x2));
+        hi = std::max(hi, std::max(x1, x2));
+    };
+
+    // bords de ligne élargis d'un millionième de cellule contre les arrondis de cell_of
+    const double pad_y = 1e-6 * m_dy;
+    const double pad_x = 1e-6 * m_dx;
+    for (std::size_t cy = cy0; cy <= cy1; ++cy) {
+        const double ylo = m_bbox.miny + static_cast<double>(cy) * m_dy - pad_y;
+        const double yhi = m_bbox.miny + static_cast<double>(cy + 1) * m_dy + pad_y;
+
+        double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+        section(cy == cy0 ? a.y : ylo, lo, hi);
+        section(cy == cy1 ? c.y : yhi, lo, hi);
+        if ((cy == cy0 || b.y >= ylo) && (cy == cy1 || b.y <= yhi)) {
+            lo = std::min(lo, b.x);
+            hi = std::max(hi, b.x);
+        }
+
+        const std::size_t rx0 = std::max(cx0, clamp_index(static_cast<long>(std::floor((lo - pad_x - m_bbox.minx) / m_dx)), m_nx));
+        const std::size_t rx1 = std::min(cx1, clamp_index(static_cast<long>(std::floor((hi + pad_x - m_bbox.minx) / m_dx)), m_nx));
+        for (std::size_t cx = rx0; cx <= rx1; ++cx) {
+            m_cells[cell_index(cx, cy)].push_back(ti);
+        }
+    }
+}
+
+void Grid::remove(std::size_t ti, const BBox2D& tb) {
+    std::size_t cx0, cx1, cy0, cy1;
+    cell_range(tb, cx0, cx1, cy0, cy1);
+    for (std::size_t cy = cy0; cy <= cy1; ++cy) {
+        for (std::size_t cx = cx0; cx <= cx1; ++cx) {
+            auto& c = m_cells[cell_index(cx, cy)];
+            const auto it = std::find(c.begin(), c.end(), ti);
+            if (it == c.end()) continue;
+            *it = c.back(); // ordre des candidats sans importance
+            c.pop_back();
+        }
     }
 }
 
@@ -71,3 +166,4 @@ std::size_t Grid::nx() const {
 std::size_t Grid::ny() const { 
     return m_ny; 
 }
+
@@ -0,0 +1,464 @@
+#include "incrementaltin.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <zlib.h>
+#include "delaunay.hpp"
+#include "grid.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+// Fichier d'état : format binaire natif (cache local, relu par la même machine)
+const char STATE_MAGIC[8] = {'M', 'N', 'T', 'T', 'I', 'N', '0', '2'};
+
+template <class T>
+void put(std::ostream& os, const T& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "type non copiable");
+    os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <class T>
+void put_vec(std::ostream& os, const std::vector<T>& v)
+{
+    put<std::uint64_t>(os, v.size());
+    os.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+void put_str(std::ostream& os, const std::string& s)
+{
+    put<std::uint64_t>(os, s.size());
+    os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+// Lecture bornée par la taille restante du fichier (état tronqué ou corrompu)
+struct Reader {
+    std::ifstream& is;
+    std::uint64_t left;
+    bool ok = true;
+
+    template <class T>
+    T get() {
+        T v{};
+        if (!ok || left < sizeof(T)) { ok = false; return v; }
+        is.read(reinterpret_cast<char*>(&v), sizeof(T));
+        left -= sizeof(T);
+        ok = (bool)is;
+        return v;
+    }
+
+    template <class T>
+    std::vector<T> get_vec() {
+        const std::uint64_t n = get<std::uint64_t>();
+        std::vector<T> v;
+        if (!ok || n > left / sizeof(T)) { ok = false; return v; }
+        v.resize(n);
+        is.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(n * sizeof(T)));
+        left -= n * sizeof(T);
+        ok = (bool)is;
+        return v;
+    }
+
+    std::string get_str() {
+        const std::vector<char> v = get_vec<char>();
+        return std::string(v.begin(), v.end());
+    }
+};
+
+bool on_segment(const Vec2& a, const Vec2& b, double px, double py)
+{
+    return (px - a.x) * (px - b.x) + (py - a.y) * (py - b.y) <= 0.0;
+}
+
+bool same_point(const Vec2& a, double px, double py)
+{
+    return std::fabs(a.x - px) <= 1e-9 && std::fabs(a.y - py) <= 1e-9;
+}
+
+}
+
+IncrementalTin::IncrementalTin(const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, std::size_t width)
+    : m_bbox(bbox), m_zmin(zmin), m_zmax(zmax)
+{
+    if (pts.size() < 3) throw std::runtime_error("IncrementalTin: au moins 3 points requis.");
+
+    std::vector<double> coords;
+    std::vector<double> alts;
+    coords.reserve(pts.size() * 2);
+    alts.reserve(pts.size());
+    for (const auto& q : pts) {
+        coords.push_back(q.x);
+        coords.push_back(q.y);
+        alts.push_back(q.z);
+    }
+
+    std::vector<std::size_t> tris = Delaunay::triangulate(coords, &m_halfedges);
+    m_mesh = std::make_unique<Mesh2D>(std::move(coords), std::move(tris), std::move(alts));
+    build_index();
+    init_hull();
+
+    Rasterizer(*m_locator, m_bbox, m_zmin, m_zmax).rasterize_z(m_bbox, width, m_zr);
+}
+
+void IncrementalTin::build_index()
+{
+    // environ deux triangles par cellule, au plus 1000 x 1000 comme TerrainPipeline
+    const double cells = std::max(1.0, (double)m_mesh->triangle_count() / 2.0);
+    const double aspect = std::max(1e-6, (m_bbox.maxx - m_bbox.minx) / std::max(1e-12, m_bbox.maxy - m_bbox.miny));
+    const std::size_t nx = std::clamp<std::size_t>((std::size_t)std::sqrt(cells * aspect), 1, 1000);
+    const std::size_t ny = std::clamp<std::size_t>((std::size_t)std::sqrt(cells / aspect), 1, 1000);
+    m_locator = std::make_unique<TriangleLocator>(*m_mesh, Grid(*m_mesh, m_bbox, nx, ny));
+}
+
+void IncrementalTin::init_hull()
+{
+    m_hull.clear();
+    for (std::size_t e = 0; e < m_halfedges.size(); ++e) {
+        if (m_halfedges[e] == Delaunay::NO_EDGE) m_hull.insert(e);
+    }
+
+    // sens des triangles : celui du premier triangle non plat
+    const auto& T = m_mesh->triangles();
+    for (std::size_t t = 0; t < m_mesh->triangle_count(); ++t) {
+        const Vec2 c = m_mesh->vertex(T[3 * t + 2]);
+        const double o = orient(T[3 * t], T[3 * t + 1], c.x, c.y);
+        if (o != 0.0) {
+            m_sign = o > 0.0 ? m_sign : -m_sign;
+            break;
+        }
+    }
+}
+
+double IncrementalTin::orient(std::size_t a, std::size_t b, double px, double py) const
+{
+    const Vec2 A = m_mesh->vertex(a);
+    const Vec2 B = m_mesh->vertex(b);
+    return m_sign * ((B.x - A.x) * (py - A.y) - (B.y - A.y) * (px - A.x));
+}
+
+bool IncrementalTin::in_circumcircle(std::size_t t, double px, double py) const
+{
+    std::size_t ia, ib, ic;
+    m_mesh->triangle_indices(t, ia, ib, ic);
+    const Vec2 A = m_mesh->vertex(ia);
+    const Vec2 B = m_mesh->vertex(ib);
+    const Vec2 C = m_mesh->vertex(ic);
+
+    const double adx = A.x - px, ady = A.y - py;
+    const double bdx = B.x - px, bdy = B.y - py;
+    const double cdx = C.x - px, cdy = C.y - py;
+    const double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+                     - (bdx * bdx + bdy * bdy) * (adx * cdy - cdx * ady)
+                     + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+    return m_sign * det > 0.0;
+}
+
+void IncrementalTin::touch(std::size_t t)
+{
+    if (m_touched_flag.size() <= t) m_touched_flag.resize(m_mesh->triangle_count(), 0);
+    if (m_touched_flag[t]) return;
+    m_touched_flag[t] = 1;
+    m_touched.push_back(t);
+}
+
+void IncrementalTin::extend_z(double zmin, double zmax)
+{
+    m_zmin = std::min(m_zmin, zmin);
+    m_zmax = std::max(m_zmax, zmax);
+}
+
+bool IncrementalTin::insert(const std::vector<Point3D>& pts, Stats& stats)
+{
+    MNT_PROFILE_ZONE("insertion_tin");
+    for (const auto& q : pts) {
+        switch (insert_point(q.x, q.y, q.z, stats)) {
+            case Insert::Done: ++stats.inserted; break;
+            case Insert::Duplicate: ++stats.duplicates; break;
+            case Insert::Failed: return false;
+        }
+    }
+    return true;
+}
+
+IncrementalTin::Insert IncrementalTin::insert_point(double x, double y, double z, Stats& stats)
+{
+    if (m_mark.size() < m_mesh->triangle_count()) m_mark.resize(m_mesh->triangle_count(), 0);
+    m_cavity.clear();
+    m_visible.clear();
+    m_boundary.clear();
+
+    const auto& T = m_mesh->triangles();
+    auto vertex = [&](std::size_t e) { return m_mesh->vertex(T[e]); };
+
+    // 1) Germe : triangle contenant le point, sinon arêtes d'enveloppe qui le voient
+    if (const auto hit = m_locator->locate(x, y)) {
+        const std::size_t t = hit->triangle_id;
+        for (std::size_t k = 0; k < 3; ++k) {
+            if (same_point(vertex(3 * t + k), x, y)) return Insert::Duplicate;
+        }
+        m_mark[t] = 1;
+        m_cavity.push_back(t);
+    } else {
+        for (const std::size_t e : m_hull) {
+            const double o = orient(T[e], T[next_edge(e)], x, y);
+            if (o < 0.0 || (o == 0.0 && on_segment(vertex(e), vertex(next_edge(e)), x, y))) {
+                if (same_point(vertex(e), x, y) || same_point(vertex(next_edge(e)), x, y)) return Insert::Duplicate;
+                m_visible.push_back(e);
+            }
+        }
+        if (m_visible.empty()) return Insert::Failed; // ni dans un triangle ni hors de l'enveloppe
+        for (const std::size_t e : m_visible) {
+            const std::size_t t = e / 3;
+            if (!m_mark[t] && in_circumcircle(t, x, y)) {
+                m_mark[t] = 1;
+                m_cavity.push_back(t);
+            }
+        }
+    }
+
+    // 2) Cavité : triangles voisins dont le cercle circonscrit contient le point
+    for (std::size_t i = 0; i < m_cavity.size(); ++i) {
+        const std::size_t t = m_cavity[i];
+        for (std::size_t k = 0; k < 3; ++k) {
+            const std::size_t o = m_halfedges[3 * t + k];
+            if (o == Delaunay::NO_EDGE || m_mark[o / 3]) continue;
+            if (in_circumcircle(o / 3, x, y)) {
+                m_mark[o / 3] = 1;
+                m_cavity.push_back(o / 3);
+            }
+        }
+    }
+
+    // 3) Bord de la cavité (sens des triangles) : arêtes vers un triangle conservé,
+    // arêtes d'enveloppe du côté du point, arêtes d'enveloppe vues hors cavité (retournées)
+    for (const std::size_t t : m_cavity) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            const std::size_t e = 3 * t + k;
+            const std::size_t o = m_halfedges[e];
+            if (o != Delaunay::NO_EDGE) {
+                if (!m_mark[o / 3]) m_boundary.push_back({T[e], T[next_edge(e)], o});
+                continue;
+            }
+            const double ov = orient(T[e], T[next_edge(e)], x, y);
+            if (ov < 0.0 || (ov == 0.0 && on_segment(vertex(e), vertex(next_edge(e)), x, y))) continue;
+            m_boundary.push_back({T[e], T[next_edge(e)], Delaunay::NO_EDGE});
+        }
+    }
+    for (const std::size_t e : m_visible) {
+        if (!m_mark[e / 3]) m_boundary.push_back({T[next_edge(e)], T[e], e});
+    }
+
+    // 4) Cavité étoilée depuis le point (sinon arrondi dégénéré : abandon)
+    std::unordered_map<std::size_t, std::size_t> start; // sommet de départ -> arête du bord
+    bool ok = m_boundary.size() >= m_cavity.size() && !m_boundary.empty();
+    for (std::size_t i = 0; ok && i < m_boundary.size(); ++i) {
+        ok = orient(m_boundary[i].a, m_boundary[i].b, x, y) > 0.0 && start.emplace(m_boundary[i].a, i).second;
+    }
+    if (!ok) {
+        for (const std::size_t t : m_cavity) m_mark[t] = 0;
+        return Insert::Failed;
+    }
+
+    // 5) Éventail autour du nouveau sommet, dans les emplacements de la cavité puis en fin de tableau
+    Grid& grid = m_locator->index();
+    for (const std::size_t t : m_cavity) {
+        grid.remove(t, m_mesh->triangle_bbox(t));
+        for (std::size_t k = 0; k < 3; ++k) m_hull.erase(3 * t + k);
+    }
+    for (const std::size_t e : m_visible) m_hull.erase(e);
+
+    const std::size_t vp = m_mesh->add_vertex(x, y, z);
+    std::vector<std::size_t> slot(m_boundary.size());
+    for (std::size_t i = 0; i < m_boundary.size(); ++i) {
+        const std::size_t s = i < m_cavity.size() ? m_cavity[i] : m_mesh->triangle_count();
+        slot[i] = s;
+        m_mesh->set_triangle(s, m_boundary[i].a, m_boundary[i].b, vp);
+        if (m_halfedges.size() < 3 * s + 3) m_halfedges.resize(3 * s + 3, Delaunay::NO_EDGE);
+
+        const std::size_t twin = m_boundary[i].twin;
+        m_halfedges[3 * s] = twin;
+        if (twin != Delaunay::NO_EDGE) m_halfedges[twin] = 3 * s;
+        m_halfedges[3 * s + 1] = Delaunay::NO_EDGE;
+        m_halfedges[3 * s + 2] = Delaunay::NO_EDGE;
+    }
+    // arête b -> p du triangle i, opposée à p -> a du triangle qui part de b
+    for (std::size_t i = 0; i < m_boundary.size(); ++i) {
+        const auto it = start.find(m_boundary[i].b);
+        if (it == start.end()) continue;
+        m_halfedges[3 * slot[i] + 1] = 3 * slot[it->second] + 2;
+        m_halfedges[3 * slot[it->second] + 2] = 3 * slot[i] + 1;
+    }
+    for (std::size_t i = 0; i < m_boundary.size(); ++i) {
+        const std::size_t s = slot[i];
+        for (std::size_t k = 0; k < 3; ++k) {
+            if (m_halfedges[3 * s + k] == Delaunay::NO_EDGE) m_hull.insert(3 * s + k);
+        }
+        grid.insert(s);
+        touch(s);
+    }
+
+    for (const std::size_t t : m_cavity) m_mark[t] = 0;
+    stats.removed += m_cavity.size();
+    stats.created += m_boundary.size();
+    return Insert::Done;
+}
+
+IncrementalTin::PixelRect IncrementalTin::update_raster()
+{
+    MNT_PROFILE_ZONE("raster_incremental");
+    PixelRect r{m_zr.width, m_zr.height, 0, 0};
+    const long w = (long)m_zr.width, h = (long)m_zr.height;
+
+    for (const std::size_t t : m_touched) {
+        m_touched_flag[t] = 0;
+        const BBox2D tb = m_mesh->triangle_bbox(t);
+
+        // centres de pixels (mêmes formules que rasterize_z) dans la bbox du triangle
+        const long i0 = std::max(0L, (long)std::ceil((tb.minx - m_bbox.minx) / m_zr.dx - 0.5));
+        const long i1 = std::min(w - 1, (long)std::floor((tb.maxx - m_bbox.minx) / m_zr.dx - 0.5));
+        const long j0 = std::max(0L, (long)std::ceil((m_bbox.maxy - tb.maxy) / m_zr.dy - 0.5));
+        const long j1 = std::min(h - 1, (long)std::floor((m_bbox.maxy - tb.miny) / m_zr.dy - 0.5));
+
+        for (long j = j0; j <= j1; ++j) {
+            const double y = m_bbox.maxy - (static_cast<double>(j) + 0.5) * m_zr.dy;
+            for (long i = i0; i <= i1; ++i) {
+                const double x = m_bbox.minx + (static_cast<double>(i) + 0.5) * m_zr.dx;
+                const Vec2 p{x, y};
+                double a, b, c;
+                if (!m_mesh->point_in_triangle(t, p) || !m_mesh->barycentric(t, p, a, b, c)) continue;
+
+                const std::size_t id = (std::size_t)j * m_zr.width + (std::size_t)i;
+                m_zr.z[id] = m_mesh->interpolate_z(t, a, b, c);
+                m_zr.mask[id] = 1;
+                r.x0 = std::min(r.x0, (std::size_t)i);
+                r.y0 = std::min(r.y0, (std::size_t)j);
+                r.x1 = std::max(r.x1, (std::size_t)i + 1);
+                r.y1 = std::max(r.y1, (std::size_t)j + 1);
+            }
+        }
+    }
+    m_touched.clear();
+    if (r.empty()) r = PixelRect{};
+    return r;
+}
+
+std::uint32_t IncrementalTin::fingerprint(const std::string& path, std::uint64_t bytes, bool* last_newline)
+{
+    std::ifstream is(path, std::ios::binary);
+    if (!is) throw std::runtime_error("Impossible d'ouvrir le fichier MNT : " + path);
+
+    std::vector<char> buf((std::size_t)1 << 20);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    char last = 0;
+    while (bytes > 0 && is) {
+        const std::size_t n = (std::size_t)std::min<std::uint64_t>(bytes, buf.size());
+        is.read(buf.data(), static_cast<std::streamsize>(n));
+        const std::size_t got = (std::size_t)is.gcount();
+        if (got == 0) break;
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(buf.data()), (uInt)got);
+        last = buf[got - 1];
+        bytes -= got;
+    }
+    if (last_newline) *last_newline = last == '\n';
+    return (std::uint32_t)crc;
+}
+
+void IncrementalTin::save(const std::string& path) const
+{
+    MNT_PROFILE_ZONE("etat_sauvegarde");
+    // écrit à côté puis renommé : un état interrompu n'écrase pas le précédent
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream os(tmp, std::ios::binary);
+        if (!os) throw std::runtime_error("IncrementalTin: impossible d'écrire l'état " + path);
+
+        os.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+        put_str(os, m_source.key);
+        put_str(os, m_source.path);
+        put(os, m_source.bytes);
+        put(os, m_source.lines);
+        put(os, m_source.crc);
+
+        put(os, m_bbox);
+        put(os, m_zmin);
+        put(os, m_zmax);
+        put(os, m_sign);
+        put_vec(os, m_mesh->coords());
+        put_vec(os, m_mesh->alts());
+        put_vec(os, m_mesh->triangles());
+        put_vec(os, m_halfedges);
+
+        put<std::uint64_t>(os, m_zr.width);
+        put<std::uint64_t>(os, m_zr.height);
+        put(os, m_zr.dx);
+        put(os, m_zr.dy);
+        put_vec(os, m_zr.z);
+        put_vec(os, m_zr.mask);
+
+        if (!os) throw std::runtime_error("IncrementalTin: impossible d'écrire l'état " + path);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("IncrementalTin: impossible d'écrire l'état " + path);
+    }
+}
+
+std::unique_ptr<IncrementalTin> IncrementalTin::load(const std::string& path)
+{
+    MNT_PROFILE_ZONE("etat_lecture");
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if (!is) return nullptr;
+    Reader in{is, (std::uint64_t)is.tellg()};
+    is.seekg(0);
+
+    char magic[sizeof(STATE_MAGIC)];
+    if (in.left < sizeof(magic)) return nullptr;
+    is.read(magic, sizeof(magic));
+    in.left -= sizeof(magic);
+    if (!is || !std::equal(magic, magic + sizeof(magic), STATE_MAGIC)) return nullptr;
+
+    std::unique_ptr<IncrementalTin> tin(new IncrementalTin());
+    tin->m_source.key = in.get_str();
+    tin->m_source.path = in.get_str();
+    tin->m_source.bytes = in.get<std::uint64_t>();
+    tin->m_source.lines = in.get<std::uint64_t>();
+    tin->m_source.crc = in.get<std::uint32_t>();
+
+    tin->m_bbox = in.get<BBox2D>();
+    tin->m_zmin = in.get<double>();
+    tin->m_zmax = in.get<double>();
+    tin->m_sign = in.get<double>();
+    std::vector<double> coords = in.get_vec<double>();
+    std::vector<double> alts = in.get_vec<double>();
+    std::vector<std::size_t> tris = in.get_vec<std::size_t>();
+    tin->m_halfedges = in.get_vec<std::size_t>();
+
+    ZRaster& zr = tin->m_zr;
+    zr.width = (std::size_t)in.get<std::uint64_t>();
+    zr.height = (std::size_t)in.get<std::uint64_t>();
+    zr.dx = in.get<double>();
+    zr.dy = in.get<double>();
+    zr.z = in.get_vec<double>();
+    zr.mask = in.get_vec<std::uint8_t>();
+
+    // cohérence des tailles (état tronqué ou d'un autre format)
+    if (!in.ok || in.left != 0 || coords.size() != 2 * alts.size() || tris.size() % 3 != 0
+        || tin->m_halfedges.size() != tris.size()
+        || zr.z.size() != zr.width * zr.height || zr.mask.size() != zr.z.size()
+        || std::any_of(tris.begin(), tris.end(), [&](std::size_t v) { return v >= alts.size(); })) {
+        return nullptr;
+    }
+
+    // index Grid non stocké : reconstruit en une passe, plus vite que relu
+    tin->m_mesh = std::make_unique<Mesh2D>(std::move(coords), std::move(tris), std::move(alts));
+    tin->build_index();
+    const double sign = tin->m_sign;
+    tin->init_hull();
+    tin->m_sign = sign;
+    return tin;
+}
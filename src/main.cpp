@@ -2,32 +2,80 @@
 #include <vector>
 #include <string>
 #include <cstdlib>
+#include <cmath>
 #include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <memory>
 
-#include "terraindata.hpp"
 #include "projector.hpp"
-#include "terrainprojected.hpp"
-#include "delaunator.hpp"
+#include "terrainmosaic.hpp"
+#include "terrainstream.hpp"
+#include "trianglefilter.hpp"
+#include "incrementaltin.hpp"
 
-#include "mesh2D.hpp"
-#include "grid.hpp"
-#include "trianglelocator.hpp"
 #include "rasterise.hpp"
+#include "ombrage.hpp"
+#include "terrainpipeline.hpp"
 #include "ppm.hpp"
+#include "png.hpp"
+#include "terrainderivatives.hpp"
 
 #include "fourier.hpp"
+#include "resample.hpp"
+#include "splat.hpp"
+#include "profiler.hpp"
+#include "memstats.hpp"
 
+// Durée affichée à la fin du bloc, zone du profileur si --trace,
+// pic mémoire de l'étape si --memory-report / --memory-budget
 struct Timer {
     std::string name;
     std::chrono::high_resolution_clock::time_point t0;
-    Timer(const std::string& n) : name(n), t0(std::chrono::high_resolution_clock::now()) {}
+    Profiler::Zone zone;
+    MemoryStats::Stage mem;
+    Timer(const std::string& n) : name(n), t0(std::chrono::high_resolution_clock::now()), zone(Profiler::enabled() ? Profiler::intern(n) : nullptr), mem(n) {}
     ~Timer() {
         auto t1 = std::chrono::high_resolution_clock::now();
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        char ms[32];
+        std::snprintf(ms, sizeof(ms), "%.1f", std::chrono::duration<double, std::milli>(t1 - t0).count());
         std::cout << name << " : " << ms << " ms\n";
     }
 };
 
+// --trace : résumé du profil et trace Chrome écrits en fin d'exécution
+struct TraceOutput {
+    std::string path;
+    ~TraceOutput() {
+        if (path.empty()) return;
+        Profiler::print_summary(std::cout);
+        try {
+            Profiler::write_chrome_trace(path);
+            std::cout << "Trace : " << path << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+        }
+    }
+};
+
+// Rapport mémoire par étape en fin d'exécution
+struct MemoryReport {
+    bool on = false;
+    ~MemoryReport() {
+        if (on) MemoryStats::print_report(std::cout);
+    }
+};
+
+// Décimation régulière (un point sur k) pour tenir dans le budget mémoire
+static void decimate(std::vector<Point3D>& pts, std::size_t max_points) {
+    if (max_points == 0 || pts.size() <= max_points) return;
+    const double step = (double)pts.size() / (double)max_points;
+    for (std::size_t k = 0; k < max_points; ++k) pts[k] = pts[(std::size_t)((double)k * step)];
+    pts.resize(max_points);
+    pts.shrink_to_fit();
+}
+
 bool parse(int argc, char** argv, int idx, bool defval=false) {
     if (idx >= argc) return defval;
     std::string s = argv[idx];
@@ -38,115 +86,648 @@ bool parse(int argc, char** argv, int idx, bool defval=false) {
     return defval;
 }
 
+// Options longues après les arguments positionnels : "--nom" ou "--nom=valeur"
+static bool has_option(int argc, char** argv, const std::string& name) {
+    for (int i = 3; i < argc; ++i) {
+        const std::string s = argv[i];
+        if (s == name || s.rfind(name + "=", 0) == 0) return true;
+    }
+    return false;
+}
+
+static std::string option_value(int argc, char** argv, const std::string& name, const std::string& defval) {
+    for (int i = 3; i < argc; ++i) {
+        const std::string s = argv[i];
+        if (s.rfind(name + "=", 0) == 0) return s.substr(name.size() + 1);
+    }
+    return defval;
+}
+
+// Nombre strictement positif occupant toute la valeur d'option
+static bool positive_value(const std::string& s, double& v) {
+    char* end = nullptr;
+    const double x = std::strtod(s.c_str(), &end);
+    if (s.empty() || *end != '\0' || !(x > 0.0) || !std::isfinite(x)) return false;
+    v = x;
+    return true;
+}
+
+// Image finale : PNG compressé en parallèle si l'extension est .png, sinon P6
+static void write_image(const std::string& out, std::size_t width, std::size_t height, const std::vector<std::uint8_t>& img){
+    Timer t("Ecriture image");
+    if (out.size() > 4 && out.compare(out.size() - 4, 4, ".png") == 0) {
+        PngWriter::write(out, width, height, img);
+    } else {
+        PPM::write_p6(out, width, height, img);
+    }
+}
+
+// Pente, exposition et courbures en rasters flottants (.pfm) ou colorisés (.ppm)
+static void write_derivatives(const std::string& base, const ZRaster& zr, const std::string& format){
+    TerrainDerivatives::Result d;
+    {
+        Timer t("Derivees terrain");
+        d = TerrainDerivatives::compute(zr.z, zr.mask, zr.width, zr.height, zr.dx, zr.dy);
+    }
+
+    const std::pair<const char*, const std::vector<float>*> layers[] = {
+        {"_pente", &d.slope}, {"_exposition", &d.aspect},
+        {"_courbure_plan", &d.plan_curv}, {"_courbure_profil", &d.profile_curv}
+    };
+
+    HaxbyColorMap cmap;
+    if (format == "ppm") cmap.load_cpt(std::string(RESOURCES_DIR) + "/haxby.cpt");
+
+    for (const auto& [suffix, values] : layers) {
+        const std::string name = base + suffix + (format == "ppm" ? ".ppm" : ".pfm");
+        if (format == "ppm") {
+            PPM::write_p6(name, zr.width, zr.height, TerrainDerivatives::colorize(*values, cmap));
+        } else {
+            PPM::write_pfm(name, zr.width, zr.height, *values);
+        }
+        std::cout << "Enregistré sous : " << name << "\n";
+    }
+}
+
+// Grille z -> dérivées éventuelles -> couleur -> image. Avec mmap_out (P6 seulement),
+// la couleur est écrite directement dans la projection mémoire du fichier
+static void write_raster(const std::string& out_ppm, const Rasterizer& rast, const ZRaster& zr, const Rasterizer::Params& rp, const std::string& derivatives, bool mmap_out){
+    if (!derivatives.empty()) {
+        write_derivatives(out_ppm.substr(0, out_ppm.rfind('.')), zr, derivatives);
+    }
+
+    const bool png = out_ppm.size() > 4 && out_ppm.compare(out_ppm.size() - 4, 4, ".png") == 0;
+    if (mmap_out && !png) {
+        Timer t("Couleur + ecriture (mmap)");
+        MappedP6 file(out_ppm, zr.width, zr.height);
+        rast.colorize(zr, rp, file.pixels());
+        file.close();
+    } else {
+        std::vector<std::uint8_t> img;
+        {
+            Timer t("Couleur");
+            img = rast.colorize(zr, rp);
+        }
+        write_image(out_ppm, zr.width, zr.height, img);
+    }
+    std::cout << "Enregistré sous : " << out_ppm << " (" << zr.width << "x" << zr.height << ")\n";
+}
+
 // Pipeline : points -> delaunay -> mesh -> grid -> raster -> ppm
-static void run_pipeline(const std::string& out_ppm, const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, std::size_t width, bool ombrage){
-    std::vector<double> coords;
-    std::vector<double> alts;
-    coords.reserve(pts.size() * 2);
-    alts.reserve(pts.size());
+static void run_pipeline(const std::string& out_ppm, const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, std::size_t width, const Rasterizer::Params& rp, bool smooth_normals, const TriangleFilter::Params& filter, Grid::Overlap overlap, std::size_t grid_side, const std::string& derivatives, bool mmap_out){
+    TerrainPipeline::Params pp;
+    pp.grid_nx = pp.grid_ny = grid_side;
+    pp.grid_overlap = overlap;
+    pp.tin_normals = rp.ombrage && rp.tin_shading;
+    pp.smooth_normals = smooth_normals;
+    pp.filter = filter;
+
+    const TerrainPipeline pipeline = [&] {
+        Timer t("Delaunay + index Grid");
+        return TerrainPipeline(pts, bbox, zmin, zmax, pp);
+    }();
+    if (filter.enabled()) {
+        const TriangleFilter::Stats& f = pipeline.filter_stats();
+        std::cout << "Filtrage : " << (f.long_edge + f.alpha) << " triangles ecartes (";
+        if (f.max_edge > 0.0) std::cout << "aretes > " << f.max_edge << " m : " << f.long_edge << ", ";
+        std::cout << "forme alpha : " << f.alpha << "), " << f.kept << " conserves\n";
+    }
 
-    for (const auto& p : pts) {
-        coords.push_back(p.x);
-        coords.push_back(p.y);
-        alts.push_back(p.z);
+    if (rp.ombrage && rp.tin_shading) {
+        // ombrage évalué pendant l'interpolation : pas de grille z ni de buffer d'ombrage
+        if (!derivatives.empty()) {
+            ZRaster zr;
+            pipeline.render_z(bbox, width, zr);
+            write_derivatives(out_ppm.substr(0, out_ppm.rfind('.')), zr, derivatives);
+        }
+        std::vector<std::uint8_t> img;
+        {
+            Timer t("Rendu TIN ombre");
+            img = pipeline.render(width, rp);
+        }
+        const std::size_t height = TerrainPipeline::height(bbox, width);
+        write_image(out_ppm, width, height, img);
+        std::cout << "Enregistré sous : " << out_ppm << " (" << width << "x" << height << ")\n";
+        return;
     }
 
-    std::vector<std::size_t> tris;
+    ZRaster zr;
     {
-        Timer t("Delaunay");
-        delaunator::Delaunator d(coords);
-        tris = d.triangles;
+        Timer t("Rasterisation");
+        pipeline.render_z(bbox, width, zr);
     }
+    write_raster(out_ppm, pipeline.rasterizer(), zr, rp, derivatives, mmap_out);
+}
 
-    Mesh2D mesh(coords, tris, alts);
+// Chemin Fourier direct : grille filtrée -> raster z -> ppm, sans triangulation
+static void run_grid_pipeline(const std::string& out_ppm, const FilteredGrid& g, double zmin, double zmax, std::size_t width, const Rasterizer::Params& rp, GridResampler::Interp interp, const std::string& derivatives, bool mmap_out){
+    ZRaster zr;
+    {
+        Timer t("Reechantillonnage grille");
+        zr = GridResampler::resample(g, width, interp);
+    }
+    write_raster(out_ppm, Rasterizer(g.bbox, zmin, zmax), zr, rp, derivatives, mmap_out);
+}
 
-    Grid grid(mesh, bbox, 1000, 1000);
-    TriangleLocator locator(mesh, std::move(grid));
+// Levé sur-échantillonné : points agrégés par pixel, seuls les trous sont triangulés
+static void run_splat_pipeline(const std::string& out_ppm, const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, std::size_t width, const Rasterizer::Params& rp, PointSplatter::Stat stat, const std::string& derivatives, bool mmap_out){
+    ZRaster zr;
+    PointSplatter::Info info;
+    {
+        Timer t("Agregation pixels");
+        zr = PointSplatter::splat(pts, bbox, width, stat, &info);
+    }
+    std::cout << "Agregation : pixels=" << info.splatted
+              << " bordure=" << info.ring_points
+              << " bouches=" << info.filled << "\n";
+    write_raster(out_ppm, Rasterizer(bbox, zmin, zmax), zr, rp, derivatives, mmap_out);
+}
+
+// Paramètres qui déterminent les pixels (largeur, modes, options de rendu) :
+// un état produit avec d'autres n'est pas réutilisable
+static std::string render_key(int argc, char** argv) {
+    std::string key;
+    for (int i = 2; i < argc; ++i) {
+        const std::string s = argv[i];
+        if (s.rfind("--incremental", 0) == 0 || s.rfind("--trace", 0) == 0 || s.rfind("--memory-", 0) == 0 || s == "--mmap") continue;
+        key += s + " ";
+    }
+    return key;
+}
 
-    Rasterizer rast(locator, bbox, zmin, zmax);
-    std::size_t height = 0;
-    auto img = rast.render_p6_color(width, height, ombrage, -12.0, 45.0);
+// Raison de reconstruire au lieu de compléter l'état (nullptr : état réutilisable)
+static const char* stale_state(const IncrementalTin* tin, const std::string& key, const std::string& path) {
+    if (!tin) return "pas d'etat";
+    const IncrementalTin::Source& src = tin->source();
+    if (src.key != key) return "parametres de rendu differents";
+    if (src.path != path) return "autre fichier";
 
-    PPM::write_p6(out_ppm, width, height, img);
-    std::cout << "Enregistré sous : " << out_ppm << " (" << width << "x" << height << ")\n";
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if (!is) return "fichier absent";
+    const std::uint64_t size = (std::uint64_t)is.tellg();
+    if (size < src.bytes) return "fichier raccourci";
+
+    // octets déjà lus inchangés, et dernière ligne complète si le fichier a grandi
+    bool newline = false;
+    if (IncrementalTin::fingerprint(path, src.bytes, &newline) != src.crc) return "fichier modifie";
+    if (size > src.bytes && src.bytes > 0 && !newline) return "derniere ligne completee";
+    return nullptr;
+}
+
+// Rendu complet par IncrementalTin, état écrit pour les exécutions suivantes
+static void build_incremental(const std::string& state, const std::string& key, const std::string& path, const Projector& projector, std::size_t width, const Rasterizer::Params& rp, const std::string& out, bool mmap_out){
+    TerrainStream::Result in = [&] {
+        Timer t("Lecture + projection");
+        return TerrainStream::load(path, projector);
+    }();
+    std::cout << "Lecture OK : " << in.points.size() << " points (" << in.chunks << " blocs)\n";
+
+    std::unique_ptr<IncrementalTin> tin;
+    {
+        Timer t("Delaunay + index Grid + rasterisation");
+        tin = std::make_unique<IncrementalTin>(in.points, in.bbox, in.zmin, in.zmax, width);
+    }
+    write_raster(out, Rasterizer(in.bbox, in.zmin, in.zmax), tin->raster(), rp, "", mmap_out);
+
+    IncrementalTin::Source& src = tin->source();
+    src.key = key;
+    src.path = path;
+    src.bytes = in.bytes;
+    src.lines = in.lines;
+    src.crc = IncrementalTin::fingerprint(path, in.bytes);
+    Timer t("Ecriture etat");
+    tin->save(state);
+}
+
+// Pixels du rectangle r (élargi d'un pixel : ombrage 3x3 des voisins) recoloriés
+// sur une sous-grille qui a elle-même un pixel de marge, puis réécrits dans le P6 ;
+// false si l'image existante n'est pas réutilisable
+static bool patch_output(const std::string& out, const Rasterizer& rast, const ZRaster& zr, const IncrementalTin::PixelRect& r, const Rasterizer::Params& rp){
+    if (r.empty()) return PPM::patch_p6(out, zr.width, zr.height, 0, 0, 0, 0, {});
+
+    auto grow = [](std::size_t lo, std::size_t hi, std::size_t n, std::size_t& a, std::size_t& b) {
+        a = lo > 0 ? lo - 1 : 0;
+        b = std::min(hi + 1, n);
+    };
+    std::size_t px0, px1, py0, py1, sx0, sx1, sy0, sy1;
+    grow(r.x0, r.x1, zr.width, px0, px1);
+    grow(r.y0, r.y1, zr.height, py0, py1);
+    grow(px0, px1, zr.width, sx0, sx1);
+    grow(py0, py1, zr.height, sy0, sy1);
+
+    ZRaster sub;
+    sub.width = sx1 - sx0;
+    sub.height = sy1 - sy0;
+    sub.dx = zr.dx;
+    sub.dy = zr.dy;
+    sub.z.resize(sub.width * sub.height);
+    sub.mask.resize(sub.width * sub.height);
+    for (std::size_t j = 0; j < sub.height; ++j) {
+        const std::size_t from = (sy0 + j) * zr.width + sx0;
+        std::copy_n(zr.z.begin() + from, sub.width, sub.z.begin() + j * sub.width);
+        std::copy_n(zr.mask.begin() + from, sub.width, sub.mask.begin() + j * sub.width);
+    }
+
+    const std::vector<std::uint8_t> rgb = rast.colorize(sub, rp);
+    const std::size_t pw = px1 - px0, ph = py1 - py0;
+    std::vector<std::uint8_t> patch(pw * ph * 3);
+    for (std::size_t j = 0; j < ph; ++j) {
+        const std::size_t from = ((py0 - sy0 + j) * sub.width + (px0 - sx0)) * 3;
+        std::copy_n(rgb.begin() + from, pw * 3, patch.begin() + j * pw * 3);
+    }
+    return PPM::patch_p6(out, zr.width, zr.height, px0, py0, pw, ph, patch);
+}
+
+// --incremental : état du dernier rendu relu, points ajoutés en fin de fichier
+// insérés dans le maillage, pixels des triangles créés réinterpolés et recoloriés.
+// Reconstruction complète si l'état n'est pas réutilisable, si les ajouts sortent
+// de l'emprise ou si une insertion échoue ; image entièrement recoloriée (depuis
+// la grille z de l'état) si la plage d'altitudes change ou si la couleur dépend
+// de toute l'image (ombres portées, étirement, PNG)
+static void run_incremental(const std::string& state, const std::string& key, const std::string& path, const Projector& projector, std::size_t width, const Rasterizer::Params& rp, const std::string& out, bool mmap_out){
+    std::unique_ptr<IncrementalTin> tin;
+    {
+        Timer t("Lecture etat");
+        tin = IncrementalTin::load(state);
+    }
+    if (const char* why = stale_state(tin.get(), key, path)) {
+        std::cout << "Rendu incremental : reconstruction complete (" << why << ")\n";
+        build_incremental(state, key, path, projector, width, rp, out, mmap_out);
+        return;
+    }
+
+    IncrementalTin::Source& src = tin->source();
+    TerrainStream::Params sp;
+    sp.offset = src.bytes;
+    sp.first_line = src.lines;
+    const TerrainStream::Result tail = [&] {
+        Timer t("Lecture ajouts");
+        return TerrainStream::load(path, projector, sp);
+    }();
+
+    const BBox2D& bb = tin->bbox();
+    const bool outside = !tail.points.empty() && (tail.bbox.minx < bb.minx || tail.bbox.miny < bb.miny || tail.bbox.maxx > bb.maxx || tail.bbox.maxy > bb.maxy);
+    IncrementalTin::Stats st;
+    bool inserted = false;
+    if (!outside) {
+        Timer t("Insertion TIN");
+        inserted = tin->insert(tail.points, st);
+    }
+    if (!inserted) {
+        std::cout << "Rendu incremental : reconstruction complete (" << (outside ? "ajouts hors emprise" : "insertion degeneree") << ")\n";
+        build_incremental(state, key, path, projector, width, rp, out, mmap_out);
+        return;
+    }
+
+    const double zmin0 = tin->zmin(), zmax0 = tin->zmax();
+    if (!tail.points.empty()) tin->extend_z(tail.zmin, tail.zmax);
+    IncrementalTin::PixelRect r;
+    {
+        Timer t("Rasterisation incrementale");
+        r = tin->update_raster();
+    }
+    std::cout << "Ajouts : " << tail.points.size() << " points, " << st.inserted << " inseres, " << st.duplicates << " doublons, "
+              << st.removed << " triangles remplaces par " << st.created << ", pixels " << (r.x1 - r.x0) << "x" << (r.y1 - r.y0) << "\n";
+
+    const Rasterizer rast(tin->bbox(), tin->zmin(), tin->zmax());
+    const bool png = out.size() > 4 && out.compare(out.size() - 4, 4, ".png") == 0;
+    const bool global = tin->zmin() != zmin0 || tin->zmax() != zmax0 || rp.cast_shadows || rp.stretch != ColorStretch::Mode::Linear || png;
+    bool patched = false;
+    if (!global) {
+        Timer t("Couleur + ecriture (rectangle)");
+        patched = patch_output(out, rast, tin->raster(), r, rp);
+    }
+    if (patched) {
+        std::cout << "Enregistré sous : " << out << " (" << tin->raster().width << "x" << tin->raster().height << ", rectangle modifie)\n";
+    } else {
+        write_raster(out, rast, tin->raster(), rp, "", mmap_out);
+    }
+
+    src.bytes = tail.bytes;
+    src.lines = tail.lines;
+    src.crc = IncrementalTin::fingerprint(path, tail.bytes);
+    Timer t("Ecriture etat");
+    tin->save(state);
 }
 
 int main(int argc, char** argv)
 {
     if (argc < 3) {
         std::cerr << "Utilisation : " << argv[0]
-                  << " <fichier_mnt> <largeur_pixels> [use_fourier] [use_ombrage]\n"
+                  << " <fichier_mnt[,...]> <largeur_pixels> [use_fourier] [use_ombrage] [options]\n"
+                  << "  fichier_mnt : fichier, liste separee par des virgules ou motif (tuiles/*.txt)\n"
+                  << "Options:\n"
+                  << "  --multidir[=N]   ombrage multidirectionnel (N lumieres dans [1,8], 4 par defaut)\n"
+                  << "  --shadows[=F]    ombres portees (force F dans [0,1], 0.6 par defaut)\n"
+                  << "  --derivatives[=pfm|ppm]  pente, exposition, courbures (pfm par defaut)\n"
+                  << "  --tin-shading[=smooth]   ombrage sur les normales du maillage (une passe)\n"
+                  << "  --stretch=percentile[:P]|equalize  etirement de la palette (P=1 %)\n"
+                  << "  --sigma=S        lissage Fourier (cellules, 2 par defaut)\n"
+                  << "  --filter=gaussian|butterworth[:FC]  filtre Fourier (FC en cycles/cellule)\n"
+                  << "  --filter-domain=auto|spatial|frequency\n"
+                  << "  --fill=N         rayon de remplissage des trous (cellules, -1 = illimite)\n"
+                  << "  --mask-filled    pas de points sur les cellules synthetisees\n"
+                  << "  --adaptive[=E]   echantillonnage adaptatif (tolerance verticale E, 0.5 par defaut)\n"
+                  << "  --point-budget=N nombre de points vise en mode adaptatif\n"
+                  << "  --resample=bilinear|bicubic  interpolation de la grille Fourier (bilinear par defaut)\n"
+                  << "  --fourier-tin    Fourier : echantillonnage + Delaunay au lieu du rendu direct\n"
+                  << "  --png            sortie PNG (compression parallele) au lieu de PPM\n"
+                  << "  --mmap           couleur ecrite directement dans le fichier PPM projete en memoire\n"
+                  << "  --trace[=F]      profil par etape + compteurs, trace Chrome dans F (trace.json)\n"
+                  << "  --memory-report  pic memoire par etape\n"
+                  << "  --memory-budget=T  budget memoire (ex. 2G) : strategies economes ou echec immediat\n"
+                  << "  --splat=auto|on|off  agregation des points par pixel (auto : >= 4 points/pixel)\n"
+                  << "  --splat-stat=mean|min|max  statistique par pixel (mean par defaut)\n"
+                  << "  --max-edge=L|auto[:K]  triangles ecartes si une arete depasse L m (auto : K x mediane, K=10)\n"
+                  << "  --grid-overlap=exact|bbox  cellules de l'index : recoupees par le triangle ou toute sa bbox\n"
+                  << "  --alpha=R        forme alpha : triangles ecartes si le rayon circonscrit depasse R m\n"
+                  << "  --seam-tolerance=T  tuiles : points confondus a moins de T m (0.01 par defaut, 0 = aucun)\n"
+                  << "  --incremental[=F]   points ajoutes en fin de fichier inseres dans le maillage de l'etat F\n"
+                  << "                      (<sortie>.etat par defaut), seuls les pixels touches sont recalcules\n"
                   << "Exemples:\n"
                   << "  " << argv[0] << " Guerledan.txt 800\n"
                   << "  " << argv[0] << " Guerledan.txt 800 true\n"
-                  << "  " << argv[0] << " Guerledan.txt 800 true false\n";
+                  << "  " << argv[0] << " Guerledan.txt 800 true false\n"
+                  << "  " << argv[0] << " Guerledan.txt 800 false true --multidir=6\n"
+                  << "  " << argv[0] << " 'tuiles/*.txt' 800 false true\n"
+                  << "  " << argv[0] << " Guerledan.txt 800 false true --incremental\n";
         return EXIT_FAILURE;
     }
 
-    const std::string filepath = std::string(RESOURCES_DIR) + "/" + argv[1];
+    // Un ou plusieurs fichiers (tuiles adjacentes), relatifs à RESOURCES_DIR
+    const std::vector<std::string> inputs = TerrainMosaic::expand(argv[1], RESOURCES_DIR);
     const std::size_t width = static_cast<std::size_t>(std::atoi(argv[2]));
 
 
+    TraceOutput trace;
+    if (has_option(argc, argv, "--trace")) {
+        trace.path = option_value(argc, argv, "--trace", "trace.json");
+        Profiler::enable(true);
+    }
+    MNT_PROFILE_ZONE("create_raster");
+
+    // Budget mémoire : rapport par étape, stratégies choisies avant les grosses allocations
+    MemoryReport memory_report;
+    std::size_t memory_budget = 0;
+    if (has_option(argc, argv, "--memory-budget")) {
+        try {
+            memory_budget = MemoryBudget::parse_size(option_value(argc, argv, "--memory-budget", "0"));
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << " (attendu : octets ou suffixe K, M, G, ex. 2G)\n";
+            return EXIT_FAILURE;
+        }
+    }
+    memory_report.on = memory_budget > 0 || has_option(argc, argv, "--memory-report");
+    MemoryStats::enable(memory_report.on);
+
     const bool USE_FOURIER  = parse(argc, argv, 3, false);
     const bool USE_OMBRAGE  = parse(argc, argv, 4, false);
 
     std::cout << "fourier=" << (USE_FOURIER ? "true" : "false")
               << " ombrage=" << (USE_OMBRAGE ? "true" : "false") << "\n";
 
-    // 1) Lecture
-    TerrainData terrain;
+    // Paramètres de rendu (avant la lecture : --incremental peut l'éviter)
+    const std::string ext = has_option(argc, argv, "--png") ? ".png" : ".ppm";
+    const std::string out = (USE_FOURIER? (USE_OMBRAGE ? "mnt_avec_fourier_avec_ombrage" : "mnt_avec_fourier_sans_ombrage")
+    : (USE_OMBRAGE ? "mnt_sans_fourier_avec_ombrage" : "mnt_sans_fourier_sans_ombrage")) + ext;
+
+    Rasterizer::Params rp;
+    rp.ombrage = USE_OMBRAGE;
+    rp.azimuth_deg = -12.0;
+    rp.altitude_deg = 45.0;
+    rp.multidirectional = has_option(argc, argv, "--multidir");
     {
-        Timer t("Lecture fichier");
-        terrain.load_data_from_file(filepath);
+        // validé ici : une valeur hors [1, MAX_LIGHTS] n'échouerait qu'à la colorisation
+        const std::string n = option_value(argc, argv, "--multidir", "4");
+        char* end = nullptr;
+        const long lights = std::strtol(n.c_str(), &end, 10);
+        if (n.empty() || *end != '\0' || lights < 1 || lights > (long)Ombrage::MAX_LIGHTS) {
+            std::cerr << "--multidir=" << n << " : nombre de lumieres entre 1 et " << Ombrage::MAX_LIGHTS << " attendu\n";
+            return EXIT_FAILURE;
+        }
+        rp.light_count = static_cast<std::size_t>(lights);
     }
-    std::cout << "Lecture OK : " << terrain.size() << " points\n";
 
-    // 2) Projection
-    Projector projector;
-    TerrainProjected proj(terrain, projector);
+    rp.cast_shadows = has_option(argc, argv, "--shadows");
+    rp.shadow_strength = std::atof(option_value(argc, argv, "--shadows", "0.6").c_str());
 
-    BBox2D bbox{proj.min_x(), proj.min_y(), proj.max_x(), proj.max_y()};
+    const std::string stretch = option_value(argc, argv, "--stretch", "linear");
+    if (stretch.rfind("percentile", 0) == 0) {
+        rp.stretch = ColorStretch::Mode::Percentile;
+        const auto colon = stretch.find(':');
+        if (colon != std::string::npos) rp.stretch_clip_pct = std::atof(stretch.c_str() + colon + 1);
+    } else if (stretch == "equalize") {
+        rp.stretch = ColorStretch::Mode::Equalize;
+    }
 
-    // 3) Points projetés (x,y,z)
-    std::vector<Point3D> pts_proj;
-    pts_proj.reserve(terrain.points().size());
-    {
-        Timer t("Assemblage points projetes (x,y,z)");
-        const auto& P = proj.points();
-        const auto& G = terrain.points(); // altitudes
-        for (std::size_t i = 0; i < P.size(); ++i) {
-            pts_proj.push_back({P[i].x, P[i].y, G[i].alt});
+    rp.tin_shading = has_option(argc, argv, "--tin-shading");
+    const bool smooth_normals = option_value(argc, argv, "--tin-shading", "") == "smooth";
+    if (rp.tin_shading && (rp.multidirectional || rp.cast_shadows)) {
+        std::cout << "--tin-shading : lumiere unique, --multidir et --shadows ignores\n";
+    }
+
+    const std::string derivatives = has_option(argc, argv, "--derivatives") ? option_value(argc, argv, "--derivatives", "pfm") : "";
+    bool mmap_out = has_option(argc, argv, "--mmap");
+
+    // Triangles écartés après Delaunay : arêtes trop longues (m, ou auto[:K] = K x médiane), forme alpha
+    TriangleFilter::Params filter;
+    if (has_option(argc, argv, "--max-edge")) {
+        const std::string max_edge = option_value(argc, argv, "--max-edge", "");
+        bool ok = true;
+        if (max_edge == "auto") filter.edge_factor = 10.0;
+        else if (max_edge.rfind("auto:", 0) == 0) ok = positive_value(max_edge.substr(5), filter.edge_factor);
+        else ok = positive_value(max_edge, filter.max_edge);
+        if (!ok) {
+            std::cerr << "--max-edge=" << max_edge << " : longueur L > 0 ou auto[:K] avec K > 0 attendu\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (has_option(argc, argv, "--alpha")) {
+        const std::string alpha = option_value(argc, argv, "--alpha", "");
+        if (!positive_value(alpha, filter.alpha)) {
+            std::cerr << "--alpha=" << alpha << " : rayon R > 0 attendu\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Rendu incrémental : levé unique rendu par le maillage (pas de Fourier,
+    // d'ombrage TIN, de dérivées ni d'agrégation), sinon rendu complet habituel
+    if (has_option(argc, argv, "--incremental")) {
+        const std::string splat_opt = option_value(argc, argv, "--splat", has_option(argc, argv, "--splat") ? "on" : "auto");
+        const char* why = inputs.size() > 1 ? "plusieurs fichiers"
+                        : USE_FOURIER ? "Fourier"
+                        : rp.tin_shading ? "--tin-shading"
+                        : !derivatives.empty() ? "--derivatives"
+                        : splat_opt == "on" ? "--splat"
+                        : filter.enabled() ? "--max-edge / --alpha"
+                        : memory_budget ? "--memory-budget" : nullptr;
+        if (!why) {
+            const std::string state = option_value(argc, argv, "--incremental", out + ".etat");
+            Projector projector;
+            run_incremental(state, render_key(argc, argv), inputs[0], projector, width, rp, out, mmap_out);
+            return 0;
+        }
+        std::cout << "--incremental ignore (" << why << ") : rendu complet\n";
+    }
+
+    if (memory_budget) {
+        std::size_t n_est = 0;
+        for (const auto& path : inputs) n_est += MemoryBudget::estimate_points(path);
+        // tuiles : points de chaque fichier puis copie fusionnée
+        const std::size_t merge = inputs.size() > 1 ? n_est * sizeof(Point3D) : 0;
+        const std::size_t need = MemoryStats::current_rss() + MemoryBudget::input_bytes(n_est) + merge;
+        std::cout << "Budget memoire : " << MemoryBudget::format(memory_budget)
+                  << ", lecture estimee " << MemoryBudget::format(need) << " (~" << n_est << " points)\n";
+        if (need > memory_budget) {
+            std::cerr << "Budget memoire insuffisant pour la lecture : " << MemoryBudget::format(need)
+                      << " estimes > " << MemoryBudget::format(memory_budget) << "\n";
+            return EXIT_FAILURE;
         }
     }
 
-    // 4) Choix points pour Delaunay : direct ou Fourier
-    std::vector<Point3D> pts_for_delaunay = pts_proj;
+    // 1) Lecture + projection en flux : blocs analysés par le pool pendant que
+    // les précédents sont projetés, emprise et altitudes réduites au fil des blocs.
+    // Plusieurs fichiers : chargés en parallèle, points des raccords dédoublonnés
+    Projector projector;
+    TerrainMosaic::Params mp;
+    mp.seam_tolerance = std::atof(option_value(argc, argv, "--seam-tolerance", "0.01").c_str());
+    TerrainMosaic::Result input = [&] {
+        Timer t("Lecture + projection");
+        return TerrainMosaic::load(inputs, projector, mp);
+    }();
+    std::cout << "Lecture OK : " << input.points.size() << " points (" << input.chunks << " blocs";
+    if (input.files > 1) {
+        std::cout << ", " << input.files << " fichiers, " << input.duplicates << " doublons retires sur "
+                  << input.seam_points << " points de raccord";
+    }
+    std::cout << ")\n";
+
+    const BBox2D bbox = input.bbox;
+    const double zmin = input.zmin;
+    const double zmax = input.zmax;
+    std::vector<Point3D> pts_proj = std::move(input.points);
+
+    // 4) Choix points pour Delaunay : direct ou Fourier (sans copie des points)
+    // Par défaut la grille filtrée est rendue directement (pas de Delaunay)
+    const bool fourier_direct = USE_FOURIER && !has_option(argc, argv, "--fourier-tin");
+    std::vector<Point3D> pts_fourier;
+    std::vector<Point3D>& pts_for_delaunay = (USE_FOURIER && !fourier_direct) ? pts_fourier : pts_proj;
+    FilteredGrid fgrid;
 
     if (USE_FOURIER) {
         FourierPreprocess::Params p;
         p.grid_scale  = 1.0;
-        p.fill_iters  = 4;
-        p.sigma_px    = 2.0;
+        p.fill_iters  = std::atoi(option_value(argc, argv, "--fill", "4").c_str());
+        p.keep_filled = !has_option(argc, argv, "--mask-filled");
+        if (has_option(argc, argv, "--adaptive")) {
+            p.sampling = FourierPreprocess::Sampling::Adaptive;
+            p.max_error = std::atof(option_value(argc, argv, "--adaptive", "0.5").c_str());
+            p.point_budget = static_cast<std::size_t>(std::atoll(option_value(argc, argv, "--point-budget", "0").c_str()));
+        }
+        p.sigma_px    = std::atof(option_value(argc, argv, "--sigma", "2.0").c_str());
         p.sample_step = 2;
         p.pow2_grid   = true;
 
+        const std::string filter = option_value(argc, argv, "--filter", "gaussian");
+        if (filter.rfind("butterworth", 0) == 0) {
+            p.filter = FourierPreprocess::Filter::Butterworth;
+            const auto colon = filter.find(':');
+            if (colon != std::string::npos) p.cutoff = std::atof(filter.c_str() + colon + 1);
+        }
+        const std::string domain = option_value(argc, argv, "--filter-domain", "auto");
+        if (domain == "spatial")   p.domain = FourierPreprocess::Domain::Spatial;
+        if (domain == "frequency") p.domain = FourierPreprocess::Domain::Frequency;
+
         {
             Timer t("Fourier");
             FourierPreprocess fp(p);
-            pts_for_delaunay = fp.run(pts_proj, bbox, width);
+            if (fourier_direct) {
+                fgrid = fp.run_grid(pts_proj, bbox, width);
+            } else {
+                pts_fourier = fp.run(pts_proj, bbox, width);
+            }
+            std::vector<Point3D>().swap(pts_proj);
 
             auto info = fp.last_grid();
             std::cout << "Fourier grid: " << info.gw << "x" << info.gh
-                      << " step=" << p.sample_step
-                      << " pts_out=" << pts_for_delaunay.size() << "\n";
+                      << " filtre=" << (info.frequency_domain ? "FFT" : "spatial")
+                      << " cellules_remplies=" << info.filled;
+            if (fourier_direct) std::cout << " rendu=direct\n";
+            else std::cout << " step=" << p.sample_step << " pts_out=" << pts_for_delaunay.size() << "\n";
         }
     }
 
-    // 5) Raster
-    const std::string out = USE_FOURIER? (USE_OMBRAGE ? "mnt_avec_fourier_avec_ombrage.ppm" : "mnt_avec_fourier_sans_ombrage.ppm")
-    : (USE_OMBRAGE ? "mnt_sans_fourier_avec_ombrage.ppm" : "mnt_sans_fourier_sans_ombrage.ppm");
+    // Sous budget : sortie projetée, agrégation par pixel, décimation, ou échec avant allocation
+    MemoryBudget::Plan plan;
+    if (memory_budget) {
+        const std::size_t pixels = width * Rasterizer::output_height(bbox, width);
+        const bool tin = rp.ombrage && rp.tin_shading && !fourier_direct;
+        try {
+            plan = MemoryBudget::plan(memory_budget, MemoryStats::current_rss(), fourier_direct ? 0 : pts_for_delaunay.size(), pixels,
+                                      rp.ombrage, rp.cast_shadows, !derivatives.empty(),
+                                      !fourier_direct && !tin, ext == ".ppm" && !tin);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        mmap_out = mmap_out || plan.mmap_output;
+        std::cout << "Budget memoire : pic estime " << MemoryBudget::format(plan.estimate)
+                  << (plan.mmap_output ? ", sortie projetee" : "")
+                  << (plan.splat ? ", agregation par pixel" : "");
+        if (plan.grid_side != MemoryBudget::GRID_SIDE) std::cout << ", index Grid " << plan.grid_side << " x " << plan.grid_side;
+        if (plan.max_points) std::cout << ", decimation a " << plan.max_points << " points";
+        std::cout << "\n";
+        decimate(pts_for_delaunay, plan.max_points);
+    }
+
+    if (fourier_direct) {
+        if (rp.tin_shading) {
+            std::cout << "--tin-shading : pas de maillage en rendu Fourier direct, ombrage sur la grille\n";
+            rp.tin_shading = false;
+        }
+        if (filter.enabled()) {
+            std::cout << "--max-edge / --alpha : pas de maillage en rendu Fourier direct, filtrage ignore\n";
+        }
+        const auto interp = option_value(argc, argv, "--resample", "bilinear") == "bicubic"
+            ? GridResampler::Interp::Bicubic : GridResampler::Interp::Bilinear;
+        run_grid_pipeline(out, fgrid, zmin, zmax, width, rp, interp, derivatives, mmap_out);
+        return 0;
+    }
 
-    run_pipeline(out, pts_for_delaunay, bbox, terrain.min_alt(), terrain.max_alt(), width, USE_OMBRAGE);
+    // Agrégation directe si le levé compte assez de points par pixel de sortie
+    const std::string splat = option_value(argc, argv, "--splat", has_option(argc, argv, "--splat") ? "on" : "auto");
+    bool use_splat = plan.splat || splat == "on" || (splat == "auto" && PointSplatter::worthwhile(pts_for_delaunay.size(), width, Rasterizer::output_height(bbox, width)));
+    if (use_splat && rp.ombrage && rp.tin_shading) {
+        if (splat == "on") {
+            std::cout << "--tin-shading : pas de maillage en mode agregation, ombrage sur la grille\n";
+            rp.tin_shading = false;
+        } else {
+            use_splat = false;
+        }
+    }
+
+    if (filter.enabled() && use_splat) {
+        std::cout << "--max-edge / --alpha : pas de maillage complet en mode agregation, filtrage ignore\n";
+    }
+
+    if (use_splat) {
+        const std::string stat_name = option_value(argc, argv, "--splat-stat", "mean");
+        const PointSplatter::Stat stat = stat_name == "min" ? PointSplatter::Stat::Min
+                                       : stat_name == "max" ? PointSplatter::Stat::Max
+                                       : PointSplatter::Stat::Mean;
+        run_splat_pipeline(out, pts_for_delaunay, bbox, zmin, zmax, width, rp, stat, derivatives, mmap_out);
+        return 0;
+    }
+
+    // Index : cellules recoupées par chaque triangle (bbox : comparaison avec --trace)
+    const Grid::Overlap overlap = option_value(argc, argv, "--grid-overlap", "exact") == "bbox" ? Grid::Overlap::BBox : Grid::Overlap::Exact;
+    try {
+        run_pipeline(out, pts_for_delaunay, bbox, zmin, zmax, width, rp, smooth_normals, filter, overlap, plan.grid_side, derivatives, mmap_out);
+    } catch (const std::runtime_error& e) {
+        // seuil --max-edge / --alpha écartant tous les triangles, etc.
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
 
     return 0;
 }
@@ -0,0 +1,261 @@
+#include "memstats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+struct Record {
+    std::string name;
+    std::size_t depth;
+    std::size_t before;
+    std::size_t peak;   // pic absolu observé pendant l'étape
+    std::size_t after;
+};
+
+std::mutex g_mutex;
+bool g_enabled = false;
+std::vector<Record> g_records;
+std::vector<std::size_t> g_stack; // indices dans g_records
+
+// Champ "Nom:   1234 kB" de /proc/self/status, en octets
+std::size_t status_field(const char* field)
+{
+    std::ifstream ifs("/proc/self/status");
+    std::string line;
+    const std::string key = std::string(field) + ":";
+    while (std::getline(ifs, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            return (std::size_t)std::strtoull(line.c_str() + key.size(), nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+std::size_t MemoryStats::current_rss()
+{
+    return status_field("VmRSS");
+}
+
+std::size_t MemoryStats::peak_rss()
+{
+    return status_field("VmHWM");
+}
+
+bool MemoryStats::reset_peak()
+{
+    // "5" : remise à zéro du pic de RSS (Linux >= 4.0)
+    std::ofstream ofs("/proc/self/clear_refs");
+    if (!ofs) return false;
+    ofs << "5";
+    return (bool)ofs;
+}
+
+void MemoryStats::enable(bool on)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_enabled = on;
+}
+
+bool MemoryStats::enabled()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_enabled;
+}
+
+MemoryStats::Stage::Stage(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_enabled) return;
+
+    // pic courant reporté sur l'étape englobante avant la remise à zéro
+    const std::size_t peak = peak_rss();
+    if (!g_stack.empty()) {
+        Record& parent = g_records[g_stack.back()];
+        parent.peak = std::max(parent.peak, peak);
+    }
+
+    const std::size_t rss = current_rss();
+    g_records.push_back({name, g_stack.size(), rss, rss, 0});
+    g_stack.push_back(g_records.size() - 1);
+    reset_peak();
+    m_active = true;
+}
+
+MemoryStats::Stage::~Stage()
+{
+    if (!m_active) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    Record& r = g_records[g_stack.back()];
+    r.peak = std::max(r.peak, peak_rss());
+    r.after = current_rss();
+    const std::size_t peak = r.peak;
+    g_stack.pop_back();
+
+    if (!g_stack.empty()) {
+        Record& parent = g_records[g_stack.back()];
+        parent.peak = std::max(parent.peak, peak);
+    }
+}
+
+void MemoryStats::print_report(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    os << "Memoire par etape (RSS avant / pic pendant / apres) :\n";
+    std::size_t overall = 0;
+    for (const auto& r : g_records) {
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "%10s %10s (+%s) %10s",
+                      MemoryBudget::format(r.before).c_str(), MemoryBudget::format(r.peak).c_str(),
+                      MemoryBudget::format(r.peak > r.before ? r.peak - r.before : 0).c_str(),
+                      MemoryBudget::format(r.after).c_str());
+        const std::string label = std::string(2 * r.depth, ' ') + r.name;
+        os << "  " << label << std::string(label.size() < 38 ? 38 - label.size() : 1, ' ') << buf << "\n";
+        overall = std::max(overall, r.peak);
+    }
+    os << "Pic de RSS : " << MemoryBudget::format(std::max(overall, peak_rss())) << "\n";
+}
+
+// ---------------------------------------------------------------------------
+
+// Coûts unitaires (octets), recalés sur --memory-report (200k points, 1500 px)
+static constexpr std::size_t INPUT_PER_POINT = 24 * 2 + 16;       // Point3D (pic de réallocation), blocs en vol (TerrainStream)
+static constexpr std::size_t TIN_PER_POINT = 16 + 8 + 120 + 48;   // coords, alts, delaunator, entrées Grid
+static constexpr std::size_t GRID_PER_CELL = 24 + 48;             // cellule Grid et son allocation
+static constexpr std::size_t SPLAT_PER_POINT = 12;                // répartition par bandes (cellule + z)
+static constexpr std::size_t SPLAT_PER_PIXEL = 4 + 8 + 12;        // compte, statistique, bouchage des trous
+static constexpr std::size_t SPLAT_PER_RING = 128;                // TIN de bordure (au plus un sommet par pixel rempli)
+static constexpr std::size_t MIN_POINTS = 1000;                  // en dessous, décimer n'a plus de sens
+
+std::size_t MemoryBudget::parse_size(const std::string& s)
+{
+    char* end = nullptr;
+    const double v = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || v <= 0.0) throw std::runtime_error("MemoryBudget: taille invalide : " + s);
+
+    double mult = 1.0;
+    if (*end == 'k' || *end == 'K') mult = 1024.0;
+    if (*end == 'm' || *end == 'M') mult = 1024.0 * 1024.0;
+    if (*end == 'g' || *end == 'G') mult = 1024.0 * 1024.0 * 1024.0;
+    if (mult != 1.0) ++end;
+    if (*end != '\0') throw std::runtime_error("MemoryBudget: taille invalide : " + s);
+    return (std::size_t)(v * mult);
+}
+
+std::size_t MemoryBudget::estimate_points(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) return 0;
+    const std::size_t size = (std::size_t)ifs.tellg();
+    ifs.seekg(0);
+
+    std::string line;
+    std::size_t lines = 0, bytes = 0;
+    while (lines < 1000 && std::getline(ifs, line)) {
+        bytes += line.size() + 1;
+        ++lines;
+    }
+    if (lines == 0 || bytes == 0) return 0;
+    return (std::size_t)((double)size * (double)lines / (double)bytes);
+}
+
+std::size_t MemoryBudget::input_bytes(std::size_t npoints)
+{
+    return npoints * INPUT_PER_POINT;
+}
+
+std::size_t MemoryBudget::tin_bytes(std::size_t npoints, std::size_t grid_side)
+{
+    return npoints * TIN_PER_POINT + grid_side * grid_side * GRID_PER_CELL;
+}
+
+// Index réduit : environ une cellule par point (deux triangles), au plus GRID_SIDE
+static std::size_t reduced_grid_side(std::size_t npoints)
+{
+    const std::size_t side = (std::size_t)std::sqrt((double)npoints);
+    return std::clamp<std::size_t>(side, 1, MemoryBudget::GRID_SIDE);
+}
+
+std::size_t MemoryBudget::splat_bytes(std::size_t npoints, std::size_t pixels)
+{
+    return npoints * SPLAT_PER_POINT + pixels * SPLAT_PER_PIXEL + std::min(npoints, pixels) * SPLAT_PER_RING;
+}
+
+std::size_t MemoryBudget::raster_bytes(std::size_t pixels, bool shading, bool shadows, bool derivatives)
+{
+    std::size_t per = 8 + 1;        // z + masque
+    if (shading || shadows) per += 8; // facteur d'ombrage
+    if (shadows) per += 1;
+    if (derivatives) per += 4 * 4;
+    return pixels * per;
+}
+
+std::size_t MemoryBudget::image_bytes(std::size_t pixels)
+{
+    return pixels * 3;
+}
+
+MemoryBudget::Plan MemoryBudget::plan(std::size_t budget, std::size_t resident, std::size_t npoints, std::size_t pixels,
+                                      bool shading, bool shadows, bool derivatives, bool allow_splat, bool allow_mmap)
+{
+    const std::size_t raster = raster_bytes(pixels, shading, shadows, derivatives);
+    const std::size_t image = image_bytes(pixels);
+    Plan p;
+
+    // 1) tel quel
+    p.estimate = resident + tin_bytes(npoints) + raster + image;
+    if (p.estimate <= budget) return p;
+
+    // 2) image écrite dans le fichier projeté (pages reprises par le noyau)
+    const std::size_t out = allow_mmap ? 0 : image;
+    p.mmap_output = allow_mmap;
+    p.estimate = resident + tin_bytes(npoints) + raster + out;
+    if (p.estimate <= budget) return p;
+
+    // 3) index Grid à la mesure du nombre de points (rendu inchangé)
+    p.grid_side = reduced_grid_side(npoints);
+    p.estimate = resident + tin_bytes(npoints, p.grid_side) + raster + out;
+    if (p.estimate <= budget) return p;
+    p.grid_side = GRID_SIDE;
+
+    // 4) agrégation par pixel : pas de TIN complet
+    if (allow_splat) {
+        p.splat = true;
+        p.estimate = resident + splat_bytes(npoints, pixels) + raster + out;
+        if (p.estimate <= budget) return p;
+        p.splat = false;
+    }
+
+    // 5) décimation régulière des points avant Delaunay, index réduit avec eux ;
+    // au-delà de GRID_SIDE^2 points, l'index plein est un coût fixe
+    const std::size_t fixed = resident + raster + out;
+    if (budget > fixed) {
+        const std::size_t avail = budget - fixed;
+        p.max_points = avail / (TIN_PER_POINT + GRID_PER_CELL);
+        p.grid_side = reduced_grid_side(p.max_points);
+        if (p.grid_side == GRID_SIDE && avail > tin_bytes(0)) p.max_points = (avail - tin_bytes(0)) / TIN_PER_POINT;
+        if (p.max_points >= MIN_POINTS && p.max_points < npoints) {
+            p.estimate = resident + tin_bytes(p.max_points, p.grid_side) + raster + out;
+            return p;
+        }
+    }
+
+    throw std::runtime_error("MemoryBudget: budget " + format(budget) + " insuffisant (resident " + format(resident)
+                             + ", rendu estime " + format(resident + tin_bytes(npoints) + raster + image) + ").");
+}
+
+std::string MemoryBudget::format(std::size_t bytes)
+{
+    char buf[32];
+    if (bytes >= ((std::size_t)1 << 30)) std::snprintf(buf, sizeof(buf), "%.2f Go", (double)bytes / (double)((std::size_t)1 << 30));
+    else std::snprintf(buf, sizeof(buf), "%.1f Mo", (double)bytes / (double)((std::size_t)1 << 20));
+    return buf;
+}
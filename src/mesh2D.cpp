@@ -1,5 +1,6 @@
 #include "mesh2D.hpp"
 #include <algorithm>
+#include <cmath>
 
 Mesh2D::Mesh2D(std::vector<double> coords, std::vector<std::size_t> triangles, std::vector<double> alts): m_coords(std::move(coords)),m_triangles(std::move(triangles)),m_alts(std::move(alts)){}
 
@@ -71,6 +72,81 @@ double Mesh2D::interpolate_z(std::size_t ti, double a, double b, double c) const
     return a * m_alts[ia] + b * m_alts[ib] + c * m_alts[ic];
 }
 
+void Mesh2D::compute_normals(bool smooth) {
+    const std::size_t nt = triangle_count();
+    m_tri_normals.assign(3 * nt, 0.0);
+    m_vtx_normals.clear();
+    if (smooth) m_vtx_normals.assign(3 * vertex_count(), 0.0);
+
+    for (std::size_t ti = 0; ti < nt; ++ti) {
+        std::size_t ia, ib, ic;
+        triangle_indices(ti, ia, ib, ic);
+        const Vec2 A = vertex(ia);
+        const Vec2 B = vertex(ib);
+        const Vec2 C = vertex(ic);
+
+        const double ux = B.x - A.x, uy = B.y - A.y, uz = m_alts[ib] - m_alts[ia];
+        const double vx = C.x - A.x, vy = C.y - A.y, vz = m_alts[ic] - m_alts[ia];
+
+        // produit vectoriel (norme = 2 * aire), orienté vers le haut
+        double nx = uy * vz - uz * vy;
+        double ny = uz * vx - ux * vz;
+        double nz = ux * vy - uy * vx;
+        if (nz < 0.0) { nx = -nx; ny = -ny; nz = -nz; }
+
+        if (smooth) {
+            for (std::size_t vi : {ia, ib, ic}) {
+                m_vtx_normals[3 * vi + 0] += nx;
+                m_vtx_normals[3 * vi + 1] += ny;
+                m_vtx_normals[3 * vi + 2] += nz;
+            }
+        }
+
+        const double norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (norm > 0.0) {
+            m_tri_normals[3 * ti + 0] = nx / norm;
+            m_tri_normals[3 * ti + 1] = ny / norm;
+            m_tri_normals[3 * ti + 2] = nz / norm;
+        } else {
+            m_tri_normals[3 * ti + 2] = 1.0; // triangle dégénéré
+        }
+    }
+
+    for (std::size_t k = 0; k + 2 < m_vtx_normals.size(); k += 3) {
+        const double norm = std::sqrt(m_vtx_normals[k] * m_vtx_normals[k] + m_vtx_normals[k + 1] * m_vtx_normals[k + 1] + m_vtx_normals[k + 2] * m_vtx_normals[k + 2]);
+        if (norm > 0.0) {
+            m_vtx_normals[k] /= norm;
+            m_vtx_normals[k + 1] /= norm;
+            m_vtx_normals[k + 2] /= norm;
+        } else {
+            m_vtx_normals[k + 2] = 1.0;
+        }
+    }
+}
+
+bool Mesh2D::has_normals() const {
+    return !m_tri_normals.empty();
+}
+
+Vec3 Mesh2D::normal_at(std::size_t ti, double a, double b, double c) const {
+    if (m_vtx_normals.empty()) {
+        return { m_tri_normals[3 * ti], m_tri_normals[3 * ti + 1], m_tri_normals[3 * ti + 2] };
+    }
+
+    std::size_t ia, ib, ic;
+    triangle_indices(ti, ia, ib, ic);
+    const double* na = &m_vtx_normals[3 * ia];
+    const double* nb = &m_vtx_normals[3 * ib];
+    const double* nc = &m_vtx_normals[3 * ic];
+
+    Vec3 n{ a * na[0] + b * nb[0] + c * nc[0],
+            a * na[1] + b * nb[1] + c * nc[1],
+            a * na[2] + b * nb[2] + c * nc[2] };
+    const double norm = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+    if (norm > 0.0) { n.x /= norm; n.y /= norm; n.z /= norm; }
+    return n;
+}
+
 std::size_t Mesh2D::vertex_count()   const { 
     return m_coords.size() / 2; 
 }
@@ -90,3 +166,17 @@ const std::vector<std::size_t>& Mesh2D::triangles() const {
 const std::vector<double>& Mesh2D::alts() const { 
     return m_alts; 
 }
+
+std::size_t Mesh2D::add_vertex(double x, double y, double z) {
+    m_coords.push_back(x);
+    m_coords.push_back(y);
+    m_alts.push_back(z);
+    return m_alts.size() - 1;
+}
+
+void Mesh2D::set_triangle(std::size_t ti, std::size_t ia, std::size_t ib, std::size_t ic) {
+    if (ti == triangle_count()) m_triangles.resize(m_triangles.size() + 3);
+    m_triangles[3 * ti] = ia;
+    m_triangles[3 * ti + 1] = ib;
+    m_triangles[3 * ti + 2] = ic;
+}
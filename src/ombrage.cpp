@@ -1,6 +1,10 @@
 #include "ombrage.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "profiler.hpp"
 
 std::vector<double> Ombrage::compute(const std::vector<double>& z,
                                        std::size_t w, std::size_t h,
@@ -8,6 +12,7 @@ std::vector<double> Ombrage::compute(const std::vector<double>& z,
                                        double azimuth_deg,
                                        double altitude_deg)
 {
+    MNT_PROFILE_ZONE("ombrage");
     std::vector<double> shade(w * h, 0.0);
 
     const double az = deg2rad(azimuth_deg);
@@ -52,6 +57,202 @@ std::vector<double> Ombrage::compute(const std::vector<double>& z,
         }
     }
 
+    copy_borders(shade, w, h);
+
+    return shade;
+}
+
+template <std::size_t N>
+void Ombrage::compute_multi_n(const std::vector<double>& z, std::size_t w, std::size_t h, double dx, double dy, const std::vector<Light>& lights, std::vector<double>& shade)
+{
+    // Directions précalculées : restent en registres dans la boucle pixel
+    double lx[N], ly[N], lz[N];
+    double hx[N], hy[N]; // direction horizontale unitaire de chaque lumière
+    for (std::size_t k = 0; k < N; ++k) {
+        const double az = deg2rad(lights[k].azimuth_deg);
+        const double alt = deg2rad(lights[k].altitude_deg);
+        lx[k] = std::sin(az) * std::cos(alt);
+        ly[k] = std::cos(az) * std::cos(alt);
+        lz[k] = std::sin(alt);
+        hx[k] = std::sin(az);
+        hy[k] = std::cos(az);
+    }
+
+    const double inv2dx = 1.0 / (2.0 * dx);
+    const double inv2dy = 1.0 / (2.0 * dy);
+
+    for (std::size_t y = 1; y + 1 < h; ++y) {
+        const double* row  = z.data() + y * w;
+        const double* rowU = row - w;
+        const double* rowD = row + w;
+        double* out = shade.data() + y * w;
+
+        for (std::size_t x = 1; x + 1 < w; ++x) {
+            // même gradient que compute()
+            const double dzdx = (row[x + 1] - row[x - 1]) * inv2dx;
+            const double dzdy = (rowD[x] - rowU[x]) * inv2dy;
+
+            const double inv_norm = 1.0 / std::sqrt(dzdx*dzdx + dzdy*dzdy + 1.0);
+            const double nx = -dzdx * inv_norm;
+            const double ny = -dzdy * inv_norm;
+            const double nz = inv_norm;
+
+            // exposition : direction horizontale de la normale
+            const double g2 = dzdx*dzdx + dzdy*dzdy;
+            const double inv_g = (g2 > 1e-24) ? 1.0 / std::sqrt(g2) : 0.0;
+            const double ax = -dzdx * inv_g;
+            const double ay = -dzdy * inv_g;
+
+            double acc = 0.0;
+            double wsum = 0.0;
+            double mean = 0.0; // repli sans pondération
+            for (std::size_t k = 0; k < N; ++k) {
+                double s = nx * lx[k] + ny * ly[k] + nz * lz[k];
+                s = std::clamp(s, 0.0, 1.0);
+
+                // sin²(exposition - azimut) = 1 - cos² ; terrain plat -> poids 1
+                const double c = ax * hx[k] + ay * hy[k];
+                const double wk = 1.0 - c * c;
+
+                acc += wk * s;
+                wsum += wk;
+                mean += s;
+            }
+
+            // poids tous nuls (exposition alignée sur chaque lumière, cas
+            // courant avec une seule lumière) : moyenne simple des éclairements
+            const double s = (wsum > 1e-12) ? acc / wsum : mean / (double)N;
+            out[x] = std::pow(s, 0.9);
+        }
+    }
+}
+
+std::vector<double> Ombrage::compute_multi(const std::vector<double>& z,
+                                             std::size_t w, std::size_t h,
+                                             double dx, double dy,
+                                             const std::vector<Light>& lights)
+{
+    MNT_PROFILE_ZONE("ombrage_multi");
+    if (lights.empty()) throw std::runtime_error("Ombrage: aucune lumière.");
+    if (lights.size() > MAX_LIGHTS) throw std::runtime_error("Ombrage: trop de lumières (max 8).");
+
+    std::vector<double> shade(w * h, 0.0);
+
+    switch (lights.size()) {
+        case 1: compute_multi_n<1>(z, w, h, dx, dy, lights, shade); break;
+        case 2: compute_multi_n<2>(z, w, h, dx, dy, lights, shade); break;
+        case 3: compute_multi_n<3>(z, w, h, dx, dy, lights, shade); break;
+        case 4: compute_multi_n<4>(z, w, h, dx, dy, lights, shade); break;
+        case 5: compute_multi_n<5>(z, w, h, dx, dy, lights, shade); break;
+        case 6: compute_multi_n<6>(z, w, h, dx, dy, lights, shade); break;
+        case 7: compute_multi_n<7>(z, w, h, dx, dy, lights, shade); break;
+        default: compute_multi_n<8>(z, w, h, dx, dy, lights, shade); break;
+    }
+
+    copy_borders(shade, w, h);
+    return shade;
+}
+
+std::vector<Ombrage::Light> Ombrage::light_fan(double azimuth_deg, double altitude_deg, std::size_t count, double spread_deg)
+{
+    std::vector<Light> lights;
+    if (count == 0) return lights;
+    if (count == 1) {
+        lights.push_back({azimuth_deg, altitude_deg});
+        return lights;
+    }
+
+    const double step = spread_deg / static_cast<double>(count - 1);
+    const double first = azimuth_deg - 0.5 * spread_deg;
+    for (std::size_t k = 0; k < count; ++k) {
+        lights.push_back({first + step * static_cast<double>(k), altitude_deg});
+    }
+    return lights;
+}
+
+std::vector<std::uint8_t> Ombrage::cast_shadows(const std::vector<double>& z,
+                                               const std::vector<std::uint8_t>& mask,
+                                               std::size_t w, std::size_t h,
+                                               double dx, double dy,
+                                               double azimuth_deg,
+                                               double altitude_deg)
+{
+    MNT_PROFILE_ZONE("ombres_portees");
+    std::vector<std::uint8_t> lit(w * h, 1);
+    if (w == 0 || h == 0) return lit;
+    if (altitude_deg >= 90.0) return lit;
+    if (altitude_deg <= 0.0) {
+        std::fill(lit.begin(), lit.end(), 0);
+        return lit;
+    }
+
+    const double az = deg2rad(azimuth_deg);
+    const double tan_alt = std::tan(deg2rad(altitude_deg));
+
+    // Direction de balayage (en pixels) : on s'éloigne du soleil.
+    // Repère (colonne, ligne) identique à celui de compute().
+    const double dcol = -std::sin(az) / dx;
+    const double drow = -std::cos(az) / dy;
+
+    // Axe principal : un pas entier par itération, axe secondaire fractionnaire
+    const bool x_major = std::abs(dcol) >= std::abs(drow);
+    const std::size_t n_main  = x_major ? w : h;
+    const std::size_t n_cross = x_major ? h : w;
+    const std::size_t main_stride  = x_major ? 1 : w;
+    const std::size_t cross_stride = x_major ? w : 1;
+    const double d_main  = x_major ? dcol : drow;
+    const double d_cross = x_major ? drow : dcol;
+    const double slope = d_cross / std::abs(d_main);
+
+    // Décalage secondaire de chaque pas : la ligne o visite (k, o + shift[k]).
+    // Chaque pixel appartient à exactement une ligne -> lignes indépendantes.
+    std::vector<long> shift(n_main);
+    for (std::size_t k = 0; k < n_main; ++k) {
+        shift[k] = static_cast<long>(std::floor(static_cast<double>(k) * slope + 0.5));
+    }
+    const long lo_shift = std::min(0L, shift.back());
+    const long hi_shift = std::max(0L, shift.back());
+
+    // Longueur monde d'un pas et baisse de l'horizon correspondante
+    const double step_main  = x_major ? dx : dy;
+    const double step_cross = (x_major ? dy : dx) * slope;
+    const double drop = std::sqrt(step_main * step_main + step_cross * step_cross) * tan_alt;
+
+    const bool forward = d_main >= 0.0;
+    const long o_begin = -hi_shift;
+    const long o_end = static_cast<long>(n_cross) - lo_shift;
+
+    parallel_for(0, static_cast<std::size_t>(o_end - o_begin), [&](std::size_t l0, std::size_t l1) {
+        for (std::size_t l = l0; l < l1; ++l) {
+            const long o = o_begin + static_cast<long>(l);
+            double horizon = -std::numeric_limits<double>::infinity();
+
+            for (std::size_t k = 0; k < n_main; ++k) {
+                const long c = o + shift[k];
+                if (c < 0 || c >= static_cast<long>(n_cross)) continue;
+
+                const std::size_t m = forward ? k : n_main - 1 - k;
+                const std::size_t id = m * main_stride + static_cast<std::size_t>(c) * cross_stride;
+
+                horizon -= drop;
+                if (!mask.empty() && !mask[id]) continue;
+
+                if (z[id] < horizon) {
+                    lit[id] = 0;
+                } else {
+                    horizon = z[id];
+                }
+            }
+        }
+    }, 64);
+
+    return lit;
+}
+
+void Ombrage::copy_borders(std::vector<double>& shade, std::size_t w, std::size_t h)
+{
+    if (w < 3 || h < 3) return;
+
     // bords: copie proche (simple)
     for (std::size_t x = 0; x < w; ++x) {
         shade[0 * w + x] = shade[1 * w + x];
@@ -61,8 +262,6 @@ std::vector<double> Ombrage::compute(const std::vector<double>& z,
         shade[y * w + 0] = shade[y * w + 1];
         shade[y * w + (w - 1)] = shade[y * w + (w - 2)];
     }
-
-    return shade;
 }
 
 double Ombrage::deg2rad(double d) { 
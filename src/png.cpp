@@ -0,0 +1,246 @@
+#include "png.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <zlib.h>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+// Fenêtre deflate : dictionnaire maximal transmis d'un bloc au suivant
+static constexpr std::size_t WINDOW = 32768;
+// Taille minimale d'un bloc compressé par thread
+static constexpr std::size_t MIN_BLOCK = 128 * 1024;
+// Données par chunk IDAT
+static constexpr std::size_t MAX_IDAT = std::size_t(1) << 30;
+
+static void put_u32(std::uint8_t* p, std::uint32_t v)
+{
+    p[0] = (std::uint8_t)(v >> 24);
+    p[1] = (std::uint8_t)(v >> 16);
+    p[2] = (std::uint8_t)(v >> 8);
+    p[3] = (std::uint8_t)v;
+}
+
+static inline std::uint8_t paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (std::uint8_t)a;
+    return (std::uint8_t)(pb <= pc ? b : c);
+}
+
+// Filtre d'une ligne : les cinq filtres PNG sont évalués, celui de plus
+// petite somme des |résidus| (signés) est retenu (heuristique de libpng)
+static void filter_row(const std::uint8_t* cur, const std::uint8_t* prev, std::size_t n, std::uint8_t* out, std::uint8_t* work)
+{
+    const std::size_t bpp = 3;
+    long best_sum = -1;
+    int best = 0;
+
+    for (int f = 0; f < 5; ++f) {
+        std::uint8_t* o = work + f * n;
+        long sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const int a = i >= bpp ? cur[i - bpp] : 0;
+            const int b = prev[i];
+            const int c = i >= bpp ? prev[i - bpp] : 0;
+            std::uint8_t v = cur[i];
+            switch (f) {
+                case 1: v = (std::uint8_t)(v - a); break;
+                case 2: v = (std::uint8_t)(v - b); break;
+                case 3: v = (std::uint8_t)(v - ((a + b) >> 1)); break;
+                case 4: v = (std::uint8_t)(v - paeth(a, b, c)); break;
+                default: break;
+            }
+            o[i] = v;
+            sum += v < 128 ? v : 256 - v;
+        }
+        if (best_sum < 0 || sum < best_sum) {
+            best_sum = sum;
+            best = f;
+        }
+    }
+
+    out[0] = (std::uint8_t)best;
+    std::copy(work + best * n, work + (best + 1) * n, out + 1);
+}
+
+// Bloc deflate brut (sans en-tête zlib) amorcé par dict ; se termine par
+// Z_SYNC_FLUSH (aligné sur un octet, concaténable) ou Z_FINISH
+static bool deflate_block(const std::uint8_t* src, std::size_t len, const std::uint8_t* dict, std::size_t dict_len, int level, bool finish, std::vector<std::uint8_t>& out)
+{
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    if (dict_len) deflateSetDictionary(&zs, dict, (uInt)dict_len);
+
+    out.resize(deflateBound(&zs, (uLong)std::min<std::size_t>(len, MAX_IDAT)) + 64);
+    std::size_t used = 0;
+    int ret = Z_OK;
+
+    // avail_in / avail_out sur 32 bits : alimentation par tranches
+    while (true) {
+        const std::size_t step = std::min<std::size_t>(len, MAX_IDAT);
+        const bool last_in = step == len;
+        const int flush = last_in ? (finish ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH;
+        zs.next_in = const_cast<Bytef*>(src);
+        zs.avail_in = (uInt)step;
+
+        do {
+            if (out.size() - used < 4096) out.resize(out.size() + out.size() / 2 + 4096);
+            const std::size_t room = std::min<std::size_t>(out.size() - used, MAX_IDAT);
+            zs.next_out = out.data() + used;
+            zs.avail_out = (uInt)room;
+            ret = deflate(&zs, flush);
+            used += room - zs.avail_out;
+            if (ret == Z_STREAM_ERROR) {
+                deflateEnd(&zs);
+                return false;
+            }
+        } while (zs.avail_out == 0 || zs.avail_in != 0);
+
+        src += step;
+        len -= step;
+        if (last_in) break;
+    }
+
+    deflateEnd(&zs);
+    out.resize(used);
+    return !finish || ret == Z_STREAM_END;
+}
+
+PngWriter::PngWriter(const std::string& filename, std::size_t width, std::size_t height, int level)
+    : m_ofs(filename, std::ios::binary),
+      m_width(width),
+      m_height(height),
+      m_level(level),
+      m_prev(width * 3, 0),
+      m_adler(adler32(0L, Z_NULL, 0))
+{
+    if (width == 0 || height == 0 || width > 0x7fffffff || height > 0x7fffffff)
+        throw std::runtime_error("PngWriter: dimensions invalides.");
+    if (!m_ofs) throw std::runtime_error("PngWriter: impossible d'ouvrir le fichier de sortie.");
+
+    static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    m_ofs.write(reinterpret_cast<const char*>(signature), 8);
+
+    // IHDR : RGB 8 bits, deflate, filtrage adaptatif, non entrelacé
+    std::uint8_t ihdr[13];
+    put_u32(ihdr, (std::uint32_t)width);
+    put_u32(ihdr + 4, (std::uint32_t)height);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+    write_chunk("IHDR", ihdr, sizeof(ihdr));
+}
+
+PngWriter::~PngWriter() = default;
+
+void PngWriter::write_chunk(const char type[4], const std::uint8_t* data, std::size_t size)
+{
+    std::uint8_t head[8];
+    put_u32(head, (std::uint32_t)size);
+    std::copy(type, type + 4, head + 4);
+
+    unsigned long crc = crc32(0L, head + 4, 4);
+    if (size) crc = crc32(crc, data, (uInt)size);
+    std::uint8_t tail[4];
+    put_u32(tail, (std::uint32_t)crc);
+
+    m_ofs.write(reinterpret_cast<const char*>(head), 8);
+    if (size) m_ofs.write(reinterpret_cast<const char*>(data), (std::streamsize)size);
+    m_ofs.write(reinterpret_cast<const char*>(tail), 4);
+    if (!m_ofs) throw std::runtime_error("PngWriter: erreur d'écriture.");
+}
+
+void PngWriter::write_rows(const std::uint8_t* rgb, std::size_t rows)
+{
+    MNT_PROFILE_ZONE("png_write_rows");
+    if (m_finished) throw std::runtime_error("PngWriter: image déjà terminée.");
+    if (rows == 0) return;
+    if (m_rows + rows > m_height) throw std::runtime_error("PngWriter: trop de lignes.");
+
+    const std::size_t n = m_width * 3;
+    const std::size_t stride = n + 1;
+    const bool last_band = m_rows + rows == m_height;
+
+    // 1) filtrage, précédé des 32 Ko filtrés de la bande précédente
+    const std::size_t base = m_tail.size();
+    std::vector<std::uint8_t> filtered(base + rows * stride);
+    std::copy(m_tail.begin(), m_tail.end(), filtered.begin());
+
+    parallel_for(0, rows, [&](std::size_t r0, std::size_t r1) {
+        std::vector<std::uint8_t> work(5 * n);
+        for (std::size_t r = r0; r < r1; ++r) {
+            const std::uint8_t* prev = r == 0 ? m_prev.data() : rgb + (r - 1) * n;
+            filter_row(rgb + r * n, prev, n, filtered.data() + base + r * stride, work.data());
+        }
+    }, 16);
+
+    // 2) compression des blocs en parallèle
+    const std::size_t total = rows * stride;
+    const std::size_t nblocks = std::max<std::size_t>(1, std::min(worker_count(), total / MIN_BLOCK));
+    std::vector<std::vector<std::uint8_t>> out(nblocks);
+    std::vector<unsigned long> adlers(nblocks);
+    std::vector<std::size_t> starts(nblocks + 1);
+    for (std::size_t b = 0; b <= nblocks; ++b) starts[b] = base + b * total / nblocks;
+
+    std::atomic<bool> failed{false};
+    parallel_for(0, nblocks, [&](std::size_t b0, std::size_t b1) {
+        for (std::size_t b = b0; b < b1; ++b) {
+            const std::size_t s0 = starts[b], s1 = starts[b + 1];
+            const std::uint8_t* src = filtered.data() + s0;
+            adlers[b] = adler32_z(adler32(0L, Z_NULL, 0), src, s1 - s0);
+
+            const std::size_t dict = std::min(WINDOW, s0);
+            const bool finish = last_band && b + 1 == nblocks;
+            if (!deflate_block(src, s1 - s0, src - dict, dict, m_level, finish, out[b])) failed = true;
+        }
+    }, 1);
+    if (failed) throw std::runtime_error("PngWriter: échec de la compression.");
+
+    // 3) flux zlib : en-tête au premier bloc, Adler-32 après le dernier
+    if (m_rows == 0) {
+        static const std::uint8_t zhead[2] = {0x78, 0x9c};
+        out.front().insert(out.front().begin(), zhead, zhead + 2);
+    }
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        m_adler = adler32_combine(m_adler, adlers[b], (z_off_t)(starts[b + 1] - starts[b]));
+    }
+    if (last_band) {
+        std::uint8_t trailer[4];
+        put_u32(trailer, (std::uint32_t)m_adler);
+        out.back().insert(out.back().end(), trailer, trailer + 4);
+    }
+
+    for (const auto& o : out) {
+        for (std::size_t off = 0; off < o.size(); off += MAX_IDAT) {
+            write_chunk("IDAT", o.data() + off, std::min(MAX_IDAT, o.size() - off));
+        }
+    }
+
+    // état pour la bande suivante
+    std::copy(rgb + (rows - 1) * n, rgb + rows * n, m_prev.begin());
+    const std::size_t keep = std::min(WINDOW, filtered.size());
+    m_tail.assign(filtered.end() - (std::ptrdiff_t)keep, filtered.end());
+    m_rows += rows;
+}
+
+void PngWriter::finish()
+{
+    if (m_finished) return;
+    if (m_rows != m_height) throw std::runtime_error("PngWriter: image incomplète.");
+    write_chunk("IEND", nullptr, 0);
+    m_ofs.flush();
+    if (!m_ofs) throw std::runtime_error("PngWriter: erreur d'écriture.");
+    m_finished = true;
+}
+
+void PngWriter::write(const std::string& filename, std::size_t width, std::size_t height, const std::vector<std::uint8_t>& rgb, int level)
+{
+    if (rgb.size() != width * height * 3) throw std::runtime_error("PngWriter: buffer RGB de taille incorrecte.");
+
+    PngWriter w(filename, width, height, level);
+    w.write_rows(rgb.data(), height);
+    w.finish();
+}
@@ -1,12 +1,20 @@
 #include "ppm.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <fstream>
 #include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "profiler.hpp"
 
 void PPM::write_p6(const std::string& filename,
                          std::size_t width,
                          std::size_t height,
                          const std::vector<std::uint8_t>& rgb)
 {
+    MNT_PROFILE_ZONE("write_p6");
     if (rgb.size() != width * height * 3) {
         throw std::runtime_error("PPMWriter: buffer RGB de taille incorrecte.");
     }
@@ -21,3 +29,124 @@ void PPM::write_p6(const std::string& filename,
     ofs.write(reinterpret_cast<const char*>(rgb.data()),
               static_cast<std::streamsize>(rgb.size()));
 }
+
+void PPM::write_pfm(const std::string& filename,
+                    std::size_t width,
+                    std::size_t height,
+                    const std::vector<float>& values)
+{
+    MNT_PROFILE_ZONE("write_pfm");
+    if (values.size() != width * height) {
+        throw std::runtime_error("PPMWriter: raster PFM de taille incorrecte.");
+    }
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs) {
+        throw std::runtime_error("PPMWriter: impossible d'ouvrir le fichier de sortie.");
+    }
+
+    // En-tête PFM : échelle négative = little-endian (cf. machines x86/ARM visées)
+    ofs << "Pf\n" << width << " " << height << "\n-1.0\n";
+    for (std::size_t j = height; j-- > 0;) {
+        ofs.write(reinterpret_cast<const char*>(values.data() + j * width),
+                  static_cast<std::streamsize>(width * sizeof(float)));
+    }
+}
+
+bool PPM::patch_p6(const std::string& filename,
+                   std::size_t width,
+                   std::size_t height,
+                   std::size_t x0,
+                   std::size_t y0,
+                   std::size_t w,
+                   std::size_t h,
+                   const std::vector<std::uint8_t>& rgb)
+{
+    MNT_PROFILE_ZONE("patch_p6");
+    if (rgb.size() != w * h * 3 || x0 + w > width || y0 + h > height) {
+        throw std::runtime_error("PPMWriter: rectangle RGB de taille incorrecte.");
+    }
+
+    // en-tête attendu, tel qu'écrit par write_p6 / MappedP6
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    const int fd = ::open(filename.c_str(), O_RDWR);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    std::string found(header.size(), '\0');
+    const bool same = ::fstat(fd, &st) == 0
+        && static_cast<std::size_t>(st.st_size) == header.size() + width * height * 3
+        && ::pread(fd, &found[0], found.size(), 0) == static_cast<ssize_t>(found.size())
+        && found == header;
+    if (!same) {
+        ::close(fd);
+        return false;
+    }
+
+    bool ok = true;
+    for (std::size_t j = 0; j < h && ok; ++j) {
+        const off_t pos = static_cast<off_t>(header.size() + ((y0 + j) * width + x0) * 3);
+        ok = ::pwrite(fd, rgb.data() + j * w * 3, w * 3, pos) == static_cast<ssize_t>(w * 3);
+    }
+    if (::close(fd) != 0 || !ok) {
+        throw std::runtime_error("PPMWriter: erreur d'écriture.");
+    }
+    return true;
+}
+
+MappedP6::MappedP6(const std::string& filename,
+                   std::size_t width,
+                   std::size_t height)
+{
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    m_map_size = header.size() + width * height * 3;
+
+    m_fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        throw std::runtime_error("PPMWriter: impossible d'ouvrir le fichier de sortie.");
+    }
+
+    // blocs réservés d'emblée : un disque plein échoue ici plutôt qu'en SIGBUS
+    // à l'écriture des pages ; ftruncate seulement si le système de fichiers
+    // ne sait pas préallouer
+    int err = ::posix_fallocate(m_fd, 0, static_cast<off_t>(m_map_size));
+    if (err == EOPNOTSUPP && ::ftruncate(m_fd, static_cast<off_t>(m_map_size)) == 0) err = 0;
+    if (err != 0) {
+        ::close(m_fd);
+        throw std::runtime_error("PPMWriter: impossible de réserver le fichier de sortie.");
+    }
+
+    m_map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        ::close(m_fd);
+        throw std::runtime_error("PPMWriter: projection mémoire impossible.");
+    }
+
+    std::copy(header.begin(), header.end(), static_cast<char*>(m_map));
+    m_pixels = static_cast<std::uint8_t*>(m_map) + header.size();
+}
+
+MappedP6::~MappedP6()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void MappedP6::close()
+{
+    if (!m_map) return;
+
+    const bool synced = ::msync(m_map, m_map_size, MS_ASYNC) == 0;
+    ::munmap(m_map, m_map_size);
+    const bool closed = ::close(m_fd) == 0;
+    m_map = nullptr;
+    m_pixels = nullptr;
+    m_fd = -1;
+
+    if (!synced || !closed) {
+        throw std::runtime_error("PPMWriter: erreur d'écriture.");
+    }
+}
@@ -0,0 +1,289 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+std::atomic<bool> Profiler::s_enabled{false};
+
+namespace {
+
+struct Event {
+    const char* name;
+    std::int64_t start;  // ns depuis l'origine
+    std::int64_t dur;
+    std::uint32_t depth;
+};
+
+struct ThreadBuffer {
+    std::uint32_t tid = 0;
+    std::uint32_t depth = 0;
+    std::vector<Event> events;
+    std::uint64_t counters[(unsigned)Profiler::Counter::COUNT] = {};
+};
+
+struct Histogram {
+    std::vector<std::uint64_t> buckets;
+    std::vector<std::string> labels;
+};
+
+const char* const COUNTER_NAMES[] = {
+    "locate_calls", "locate_candidates", "locate_misses", "raster_pixels", "raster_outside",
+    "grid_triangles", "grid_entries"
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == (unsigned)Profiler::Counter::COUNT, "noms des compteurs");
+
+// Tampons possédés par le registre et non par leur thread : les workers
+// persistants de ThreadPool::shared n'ont pas de point de fin où vider leurs
+// événements, le résumé et la trace sont écrits par le thread principal, et
+// un ThreadPool local peut être détruit avant l'écriture
+std::mutex g_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::set<std::string> g_names;
+std::map<std::string, Histogram> g_histograms;
+std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer& local_buffer()
+{
+    if (!t_buffer) {
+        auto b = std::make_unique<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(g_mutex);
+        b->tid = (std::uint32_t)g_buffers.size();
+        t_buffer = b.get();
+        g_buffers.push_back(std::move(b));
+    }
+    return *t_buffer;
+}
+
+std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+std::string json_escape(const char* s)
+{
+    std::string out;
+    for (; *s; ++s) {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += (char)c;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+void Profiler::enable(bool on)
+{
+    s_enabled.store(on, std::memory_order_relaxed);
+}
+
+const char* Profiler::intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_names.insert(name).first->c_str();
+}
+
+void Profiler::Zone::begin(const char* name)
+{
+    ThreadBuffer& b = local_buffer();
+    ++b.depth;
+    m_name = name;
+    m_start = now_ns();
+}
+
+void Profiler::Zone::end()
+{
+    const std::int64_t t = now_ns();
+    ThreadBuffer& b = local_buffer();
+    --b.depth;
+    b.events.push_back({m_name, m_start, t - m_start, b.depth});
+}
+
+void Profiler::add(Counter c, std::uint64_t v)
+{
+    local_buffer().counters[(unsigned)c] += v;
+}
+
+std::uint64_t Profiler::counter(Counter c)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::uint64_t sum = 0;
+    for (const auto& b : g_buffers) sum += b->counters[(unsigned)c];
+    return sum;
+}
+
+void Profiler::histogram(const char* name, const std::vector<std::uint64_t>& buckets, const std::vector<std::string>& labels)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_histograms[name] = Histogram{buckets, labels};
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (auto& b : g_buffers) {
+        b->events.clear();
+        std::fill(std::begin(b->counters), std::end(b->counters), 0);
+    }
+    g_histograms.clear();
+    g_epoch = std::chrono::steady_clock::now();
+}
+
+void Profiler::write_chrome_trace(const std::string& path)
+{
+    std::ofstream ofs(path);
+    if (!ofs) throw std::runtime_error("Profiler: impossible d'ouvrir " + path);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto sep = [&]() {
+        if (!first) ofs << ",\n";
+        first = false;
+    };
+
+    char buf[128];
+    std::int64_t last = 0;
+    for (const auto& b : g_buffers) {
+        if (b->events.empty()) continue;
+        sep();
+        const std::string tname = b->tid == 0 ? "principal" : "thread " + std::to_string(b->tid);
+        ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+            << ",\"args\":{\"name\":\"" << tname << "\"}}";
+
+        for (const auto& e : b->events) {
+            sep();
+            std::snprintf(buf, sizeof(buf), "\"ts\":%.3f,\"dur\":%.3f", (double)e.start * 1e-3, (double)e.dur * 1e-3);
+            ofs << "{\"name\":\"" << json_escape(e.name) << "\",\"cat\":\"mnt\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << "," << buf << "}";
+            last = std::max(last, e.start + e.dur);
+        }
+    }
+
+    // compteurs et histogrammes : un événement "C" en fin de trace
+    std::uint64_t totals[(unsigned)Counter::COUNT] = {};
+    for (const auto& b : g_buffers) {
+        for (unsigned c = 0; c < (unsigned)Counter::COUNT; ++c) totals[c] += b->counters[c];
+    }
+    std::snprintf(buf, sizeof(buf), "%.3f", (double)last * 1e-3);
+    sep();
+    ofs << "{\"name\":\"compteurs\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":" << buf << ",\"args\":{";
+    for (unsigned c = 0; c < (unsigned)Counter::COUNT; ++c) {
+        ofs << (c ? "," : "") << "\"" << COUNTER_NAMES[c] << "\":" << totals[c];
+    }
+    ofs << "}}";
+
+    for (const auto& [name, h] : g_histograms) {
+        sep();
+        ofs << "{\"name\":\"" << json_escape(name.c_str()) << "\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":" << buf << ",\"args\":{";
+        for (std::size_t k = 0; k < h.buckets.size(); ++k) {
+            ofs << (k ? "," : "") << "\"" << json_escape(h.labels[k].c_str()) << "\":" << h.buckets[k];
+        }
+        ofs << "}}";
+    }
+    ofs << "\n]}\n";
+}
+
+void Profiler::print_summary(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    // chemins parent/enfant reconstruits par thread (événements triés par début)
+    struct Agg {
+        std::int64_t first = 0;
+        std::int64_t total = 0;
+        std::size_t calls = 0;
+        std::uint32_t depth = 0;
+    };
+    std::map<std::string, Agg> agg;
+
+    for (const auto& b : g_buffers) {
+        std::vector<Event> ev = b->events;
+        std::sort(ev.begin(), ev.end(), [](const Event& a, const Event& c) {
+            return a.start != c.start ? a.start < c.start : a.depth < c.depth;
+        });
+
+        std::vector<std::string> stack;
+        for (const auto& e : ev) {
+            stack.resize(std::min<std::size_t>(stack.size(), e.depth));
+            const std::string path = (stack.empty() ? std::string() : stack.back() + "/") + e.name;
+            stack.push_back(path);
+
+            auto it = agg.find(path);
+            if (it == agg.end()) it = agg.emplace(path, Agg{e.start, 0, 0, e.depth}).first;
+            it->second.first = std::min(it->second.first, e.start);
+            it->second.total += e.dur;
+            it->second.calls++;
+        }
+    }
+
+    // ordre : chemin parent d'abord, puis première apparition
+    std::vector<std::pair<std::string, Agg>> rows(agg.begin(), agg.end());
+    std::sort(rows.begin(), rows.end(), [&](const auto& a, const auto& b) {
+        auto key = [&](const std::string& p) {
+            std::vector<std::int64_t> k;
+            std::size_t pos = 0;
+            while (true) {
+                const std::size_t s = p.find('/', pos);
+                const auto it = agg.find(p.substr(0, s)); // parent encore ouvert : absent
+                k.push_back(it != agg.end() ? it->second.first : 0);
+                if (s == std::string::npos) break;
+                pos = s + 1;
+            }
+            return k;
+        };
+        const auto ka = key(a.first), kb = key(b.first);
+        return ka != kb ? ka < kb : a.first < b.first;
+    });
+
+    os << "Profil (temps cumules sur tous les threads) :\n";
+    char buf[64];
+    for (const auto& [path, a] : rows) {
+        const std::size_t slash = path.rfind('/');
+        const std::string leaf = slash == std::string::npos ? path : path.substr(slash + 1);
+        std::snprintf(buf, sizeof(buf), "%10.2f ms  x%zu", (double)a.total * 1e-6, a.calls);
+        os << "  " << std::string(2 * a.depth, ' ') << leaf
+           << std::string(leaf.size() + 2 * a.depth < 40 ? 40 - leaf.size() - 2 * a.depth : 1, ' ') << buf << "\n";
+    }
+
+    std::uint64_t t[(unsigned)Counter::COUNT] = {};
+    for (const auto& b : g_buffers) {
+        for (unsigned c = 0; c < (unsigned)Counter::COUNT; ++c) t[c] += b->counters[c];
+    }
+    const auto calls = t[(unsigned)Counter::LocateCalls];
+    const auto pixels = t[(unsigned)Counter::RasterPixels];
+    if (calls) {
+        std::snprintf(buf, sizeof(buf), "%.2f", (double)t[(unsigned)Counter::LocateCandidates] / (double)calls);
+        os << "locate : appels=" << calls << " candidats/appel=" << buf
+           << " hors triangulation=" << t[(unsigned)Counter::LocateMisses] << "\n";
+    }
+    if (const auto tris = t[(unsigned)Counter::GridTriangles]) {
+        std::snprintf(buf, sizeof(buf), "%.2f", (double)t[(unsigned)Counter::GridEntries] / (double)tris);
+        os << "grid : triangles=" << tris << " entrees=" << t[(unsigned)Counter::GridEntries] << " cellules/triangle=" << buf << "\n";
+    }
+    if (pixels) {
+        std::snprintf(buf, sizeof(buf), "%.2f %%", 100.0 * (double)t[(unsigned)Counter::RasterOutside] / (double)pixels);
+        os << "rasterize : pixels=" << pixels << " hors enveloppe=" << buf << "\n";
+    }
+    for (const auto& [name, h] : g_histograms) {
+        os << name << " :";
+        for (std::size_t k = 0; k < h.buckets.size(); ++k) os << " [" << h.labels[k] << "]=" << h.buckets[k];
+        os << "\n";
+    }
+}
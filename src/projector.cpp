@@ -2,25 +2,43 @@
 #include <iostream>
 
 Projector::Projector(const std::string& src_crs, const std::string& dst_crs)
+    : m_src_crs(src_crs), m_dst_crs(dst_crs), C(nullptr), P(nullptr)
 {
-    PJ_CONTEXT* C = PJ_DEFAULT_CTX;
+    init();
+}
+
+Projector::Projector(const Projector& other)
+    : m_src_crs(other.m_src_crs), m_dst_crs(other.m_dst_crs), C(nullptr), P(nullptr)
+{
+    init();
+}
+
+void Projector::init()
+{
+    C = proj_context_create();
 
-    P = proj_create_crs_to_crs(C,src_crs.c_str(),dst_crs.c_str(),nullptr);
+    PJ* crs = proj_create_crs_to_crs(C,m_src_crs.c_str(),m_dst_crs.c_str(),nullptr);
 
-    if (!P)
+    if (!crs) {
+        proj_context_destroy(C);
         throw std::runtime_error("Erreur PROJ : impossible d'initialiser la projection.");
+    }
 
     // PROJ prend des radian en entrées pour les coordonnées géo
-    P = proj_normalize_for_visualization(C, P);
+    P = proj_normalize_for_visualization(C, crs);
+    proj_destroy(crs);
 
-    if (!P)
+    if (!P) {
+        proj_context_destroy(C);
         throw std::runtime_error("Erreur PROJ : échec normalisation.");
+    }
 }
 
 Projector::~Projector()
 {
     if (P)
         proj_destroy(P);
+    proj_context_destroy(C);
 }
 
 Point2D Projector::project(double lon_deg, double lat_deg) const
@@ -1,13 +1,19 @@
 #include "rasterise.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include "colorkernel.hpp"
 #include "ombrage.hpp"
+#include "parallel.hpp"
+#include "profiler.hpp"
 
 Rasterizer::Rasterizer(const TriangleLocator& locator,
                        BBox2D bbox,
                        double zmin,
                        double zmax)
-    : m_locator(locator),
+    : m_locator(&locator),
       m_bbox(bbox)
 {
     m_cmap.load_cpt(std::string(RESOURCES_DIR) + "/haxby.cpt");//m_cmap.load_cpt("../resources/haxby.cpt");
@@ -15,72 +21,236 @@ Rasterizer::Rasterizer(const TriangleLocator& locator,
     m_zmax = zmax;
 }
 
+Rasterizer::Rasterizer(BBox2D bbox, double zmin, double zmax)
+    : m_locator(nullptr),
+      m_bbox(bbox)
+{
+    m_cmap.load_cpt(std::string(RESOURCES_DIR) + "/haxby.cpt");
+    m_zmin = zmin;
+    m_zmax = zmax;
+}
+
 std::vector<std::uint8_t> Rasterizer::render_p6_color(std::size_t width,std::size_t& out_height,bool ombrage_enabled,double azimuth_deg,double altitude_deg) const
+{
+    Params p;
+    p.ombrage = ombrage_enabled;
+    p.azimuth_deg = azimuth_deg;
+    p.altitude_deg = altitude_deg;
+    return render_p6_color(width, out_height, p);
+}
+
+std::vector<std::uint8_t> Rasterizer::render_p6_color(std::size_t width,std::size_t& out_height,const Params& p) const
+{
+    if (p.ombrage && p.tin_shading) {
+        out_height = output_height(m_bbox, width);
+        std::vector<std::uint8_t> img(width * out_height * channels(p.format));
+        render_tin_shaded(m_bbox, width, p, img.data());
+        return img;
+    }
+
+    const ZRaster zr = rasterize_z(width);
+    out_height = zr.height;
+    return colorize(zr, p);
+}
+
+std::size_t Rasterizer::output_height(const BBox2D& view, std::size_t width)
 {
     if (width == 0) throw std::runtime_error("Rasterizer: width == 0.");
 
-    const double bbox_w = m_bbox.maxx - m_bbox.minx;
-    const double bbox_h = m_bbox.maxy - m_bbox.miny;
-    
+    const double bbox_w = view.maxx - view.minx;
+    const double bbox_h = view.maxy - view.miny;
+
     if (bbox_w <= 0 || bbox_h <= 0) throw std::runtime_error("Rasterizer: bbox invalide.");
 
-    out_height = static_cast<std::size_t>(std::llround((bbox_h / bbox_w) * static_cast<double>(width)));
-    if (out_height == 0) out_height = 1;
+    const std::size_t h = static_cast<std::size_t>(std::llround((bbox_h / bbox_w) * static_cast<double>(width)));
+    return h == 0 ? 1 : h;
+}
+
+void Rasterizer::render_rgb(const BBox2D& view, std::size_t width, const Params& p, std::uint8_t* rgb) const
+{
+    if (p.ombrage && p.tin_shading) {
+        render_tin_shaded(view, width, p, rgb);
+        return;
+    }
+
+    ZRaster zr;
+    rasterize_z(view, width, zr);
+    colorize(zr, p, rgb);
+}
+
+void Rasterizer::render_tin_shaded(const BBox2D& view, std::size_t width, const Params& p, std::uint8_t* rgb) const
+{
+    MNT_PROFILE_ZONE("render_tin_shaded");
+    if (!m_locator) throw std::runtime_error("Rasterizer: pas de triangulation.");
+    const Mesh2D& mesh = m_locator->mesh();
+    if (!mesh.has_normals()) throw std::runtime_error("Rasterizer: normales du maillage non calculées.");
+
+    const std::size_t out_height = output_height(view, width);
+    const double bbox_w = view.maxx - view.minx;
+    const double bbox_h = view.maxy - view.miny;
 
     const double dx = bbox_w / static_cast<double>(width);
     const double dy = bbox_h / static_cast<double>(out_height);
 
-    // 1) Raster Z (double) + masque validité
-    std::vector<double> zgrid(width * out_height, 0.0);
-    std::vector<std::uint8_t> mask(width * out_height, 0);
+    // Lumière dans le repère monde (x est, y nord) ; même éclairage que Ombrage::compute
+    const double pi = 3.14159265358979323846;
+    const double az = p.azimuth_deg * pi / 180.0;
+    const double alt = p.altitude_deg * pi / 180.0;
+    const double lx = std::sin(az) * std::cos(alt);
+    const double ly = -std::cos(az) * std::cos(alt);
+    const double lz = std::sin(alt);
+
+    const std::uint8_t* lut = m_cmap.shaded_lut();
+    const double zq_max = (double)(HaxbyColorMap::Z_LEVELS - 1);
+    const double sq_max = (double)(HaxbyColorMap::SHADE_LEVELS - 1);
+    // pas de grille z dans ce mode : histogramme des altitudes des sommets
+    const auto stretch = ColorStretch::compute(mesh.alts(), {}, m_zmin, m_zmax, p.stretch, p.stretch_clip_pct);
+    const auto& remap = stretch.remap;
+    const double zscale = (stretch.zmax > stretch.zmin) ? zq_max / (stretch.zmax - stretch.zmin) : 0.0;
+
+    // format testé par pixel : coût négligeable devant la localisation
+    const std::size_t ch = channels(p.format);
+    parallel_for(0, out_height, [&](std::size_t j0, std::size_t j1) {
+        for (std::size_t j = j0; j < j1; ++j) {
+            const double y = view.maxy - (static_cast<double>(j) + 0.5) * dy;
+            for (std::size_t i = 0; i < width; ++i) {
+                const double x = view.minx + (static_cast<double>(i) + 0.5) * dx;
+                const std::size_t idx = ch * (j * width + i);
 
-    for (std::size_t j = 0; j < out_height; ++j) {
-        const double y = m_bbox.maxy - (static_cast<double>(j) + 0.5) * dy;
-        for (std::size_t i = 0; i < width; ++i) {
-            const double x = m_bbox.minx + (static_cast<double>(i) + 0.5) * dx;
+                const auto hit = m_locator->locate(x, y);
+                if (!hit) { // hors hull -> noir (transparent en RGBA)
+                    std::memset(rgb + idx, 0, ch);
+                    continue;
+                }
 
-            auto z_opt = m_locator.interpolate(x, y);
-            const std::size_t id = j * width + i;
+                const double z = mesh.interpolate_z(hit->triangle_id, hit->a, hit->b, hit->c);
+                const Vec3 n = mesh.normal_at(hit->triangle_id, hit->a, hit->b, hit->c);
 
-            if (z_opt) {
-                zgrid[id] = *z_opt;
-                mask[id] = 1;
+                double s = std::clamp(n.x * lx + n.y * ly + n.z * lz, 0.0, 1.0);
+                s = std::pow(s, 0.9);
+
+                const double t = std::min(std::max((z - stretch.zmin) * zscale, 0.0), zq_max);
+                const std::uint32_t zq = (std::uint32_t)(t + 0.5);
+                const std::uint32_t sq = (std::uint32_t)((0.35 + 0.65 * s) * sq_max + 0.5);
+                const std::uint8_t* c = lut + 3 * ((std::size_t)remap[zq] * HaxbyColorMap::SHADE_LEVELS + sq);
+
+                rgb[idx + 0] = c[0];
+                rgb[idx + 1] = c[1];
+                rgb[idx + 2] = c[2];
+                if (ch == 4) rgb[idx + 3] = 255;
             }
         }
-    }
+    }, 8);
+}
 
-    // 2) Hillshade (optionnel)
-    std::vector<double> shade;
-    if (ombrage_enabled) {
-        shade = Ombrage::compute(zgrid, width, out_height, dx, dy, azimuth_deg, altitude_deg);
-    } else {
-        shade.assign(width * out_height, 1.0);
-    }
+ZRaster Rasterizer::rasterize_z(std::size_t width) const
+{
+    ZRaster zr;
+    rasterize_z(m_bbox, width, zr);
+    return zr;
+}
+
+void Rasterizer::rasterize_z(const BBox2D& view, std::size_t width, ZRaster& zr) const
+{
+    MNT_PROFILE_ZONE("rasterize_z");
+    if (!m_locator) throw std::runtime_error("Rasterizer: pas de triangulation.");
 
-    // 3) Couleur + shading
-    std::vector<std::uint8_t> img(width * out_height * 3, 0);
+    zr.width = width;
+    zr.height = output_height(view, width);
+    zr.dx = (view.maxx - view.minx) / static_cast<double>(zr.width);
+    zr.dy = (view.maxy - view.miny) / static_cast<double>(zr.height);
 
-    for (std::size_t j = 0; j < out_height; ++j) {
-        for (std::size_t i = 0; i < width; ++i) {
-            const std::size_t id = j * width + i;
-            RGB col;
+    // Raster Z (double) + masque validité
+    zr.z.assign(zr.width * zr.height, 0.0);
+    zr.mask.assign(zr.width * zr.height, 0);
 
-            if (!mask[id]) {
-                col = {0, 0, 0}; // hors hull -> noir
-            } else {
+    // lignes réparties sur le pool ; pixels hors enveloppe comptés par bloc
+    std::atomic<std::size_t> outside{0};
+    parallel_for(0, zr.height, [&](std::size_t j0, std::size_t j1) {
+        std::size_t out = 0;
+        for (std::size_t j = j0; j < j1; ++j) {
+            const double y = view.maxy - (static_cast<double>(j) + 0.5) * zr.dy;
+            for (std::size_t i = 0; i < zr.width; ++i) {
+                const double x = view.minx + (static_cast<double>(i) + 0.5) * zr.dx;
 
-                
-                RGB col = m_cmap.color(zgrid[id], m_zmin, m_zmax);
-                double s = 0.35 + 0.65 * shade[id];   // si hillshade activé
-                col = HaxbyColorMap::shade(col, s);
+                auto z_opt = m_locator->interpolate(x, y);
+                const std::size_t id = j * zr.width + i;
+
+                if (z_opt) {
+                    zr.z[id] = *z_opt;
+                    zr.mask[id] = 1;
+                } else {
+                    ++out;
+                }
             }
+        }
+        outside += out;
+    }, 8);
+    MNT_PROFILE_COUNT(RasterPixels, zr.width * zr.height);
+    MNT_PROFILE_COUNT(RasterOutside, outside.load());
+}
 
-            const std::size_t idx = 3 * id;
-            img[idx + 0] = col.r;
-            img[idx + 1] = col.g;
-            img[idx + 2] = col.b;
+std::vector<std::uint8_t> Rasterizer::colorize(const ZRaster& zr, const Params& p) const
+{
+    std::vector<std::uint8_t> img(zr.width * zr.height * channels(p.format));
+    colorize(zr, p, img.data());
+    return img;
+}
+
+void Rasterizer::colorize(const ZRaster& zr, const Params& p, std::uint8_t* rgb) const
+{
+    MNT_PROFILE_ZONE("colorize");
+    const std::size_t width = zr.width;
+    const std::size_t out_height = zr.height;
+    const double dx = zr.dx;
+    const double dy = zr.dy;
+    const auto& zgrid = zr.z;
+    const auto& mask = zr.mask;
+
+    // 2) Hillshade (optionnel)
+    std::vector<double> shade; // vide -> pas d'ombrage (facteur 1)
+    if (p.ombrage && p.multidirectional) {
+        const auto lights = Ombrage::light_fan(p.azimuth_deg, p.altitude_deg, p.light_count);
+        shade = Ombrage::compute_multi(zgrid, width, out_height, dx, dy, lights);
+    } else if (p.ombrage) {
+        shade = Ombrage::compute(zgrid, width, out_height, dx, dy, p.azimuth_deg, p.altitude_deg);
+    }
+
+    // 2b) Ombres portées (optionnel), combinées au facteur d'ombrage
+    if (p.cast_shadows) {
+        if (shade.empty()) shade.assign(width * out_height, 1.0);
+        const auto lit = Ombrage::cast_shadows(zgrid, mask, width, out_height, dx, dy, p.azimuth_deg, p.altitude_deg);
+        const double k = 1.0 - std::clamp(p.shadow_strength, 0.0, 1.0);
+        for (std::size_t id = 0; id < shade.size(); ++id) {
+            if (!lit[id]) shade[id] *= k;
         }
     }
 
-    return img;
+    MNT_PROFILE_ZONE("couleur");
+    // 3) Couleur + shading : indices entiers dans la LUT ombrée ; chaque pixel
+    // est écrit (noir hors hull), rgb peut donc être non initialisé
+    const double zq_max = (double)(HaxbyColorMap::Z_LEVELS - 1);
+    const auto stretch = ColorStretch::compute(zgrid, mask, m_zmin, m_zmax, p.stretch, p.stretch_clip_pct);
+    const auto& remap = stretch.remap;
+    std::vector<std::uint32_t> base(remap.size());
+    for (std::size_t q = 0; q < remap.size(); ++q) base[q] = (std::uint32_t)remap[q] * HaxbyColorMap::SHADE_LEVELS;
+
+    // grille entièrement valide (grille Fourier, agrégation dense) : pas de test de masque
+    const bool masked = std::memchr(mask.data(), 0, mask.size()) != nullptr;
+    const ColorKernels::Kernel kernel = ColorKernels::select(!shade.empty(), masked, p.single_precision, channels(p.format));
+
+    ColorRows rows;
+    rows.z = zgrid.data();
+    rows.mask = mask.data();
+    rows.shade = shade.empty() ? nullptr : shade.data();
+    rows.base = base.data();
+    rows.lut = m_cmap.shaded_lut();
+    rows.width = width;
+    rows.zmin = stretch.zmin;
+    rows.zscale = (stretch.zmax > stretch.zmin) ? zq_max / (stretch.zmax - stretch.zmin) : 0.0;
+    rows.out = rgb;
+
+    parallel_for(0, out_height, [&](std::size_t j0, std::size_t j1) {
+        kernel(rows, j0, j1);
+    }, 16);
 }
\ No newline at end of file
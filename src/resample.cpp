@@ -0,0 +1,104 @@
+#include "resample.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+// Position d'un centre de pixel dans la grille : indice de la cellule de
+// gauche (peut valoir -1 ou n-1 aux bords) et fraction dans [0,1[
+struct Tap {
+    long i0;
+    double f;
+};
+
+static std::vector<Tap> taps(std::size_t n_px, std::size_t n_cells)
+{
+    std::vector<Tap> t(n_px);
+    const double scale = (double)n_cells / (double)n_px;
+    for (std::size_t i = 0; i < n_px; ++i) {
+        const double g = ((double)i + 0.5) * scale - 0.5;
+        const double fl = std::floor(g);
+        t[i] = {(long)fl, g - fl};
+    }
+    return t;
+}
+
+static inline double catmull_rom(double p0, double p1, double p2, double p3, double t)
+{
+    return p1 + 0.5 * t * (p2 - p0 + t * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3 + t * (3.0 * (p1 - p2) + p3 - p0)));
+}
+
+ZRaster GridResampler::resample(const FilteredGrid& g, std::size_t width, Interp interp)
+{
+    MNT_PROFILE_ZONE("resample");
+    if (width == 0) throw std::runtime_error("GridResampler: width == 0.");
+    if (g.gw == 0 || g.gh == 0 || g.z.size() != g.gw * g.gh || g.mask.size() != g.z.size())
+        throw std::runtime_error("GridResampler: grille invalide.");
+
+    ZRaster zr;
+    zr.width = width;
+    zr.height = Rasterizer::output_height(g.bbox, width);
+    zr.dx = (g.bbox.maxx - g.bbox.minx) / static_cast<double>(zr.width);
+    zr.dy = (g.bbox.maxy - g.bbox.miny) / static_cast<double>(zr.height);
+
+    zr.z.assign(zr.width * zr.height, 0.0);
+    zr.mask.assign(zr.width * zr.height, 0);
+
+    const long gw = (long)g.gw, gh = (long)g.gh;
+    const std::vector<Tap> tx = taps(zr.width, g.gw);
+    const std::vector<Tap> ty = taps(zr.height, g.gh);
+
+    auto cell = [&](long x, long y) { return (std::size_t)y * g.gw + (std::size_t)x; };
+    auto clampx = [&](long x) { return std::clamp(x, 0L, gw - 1); };
+    auto clampy = [&](long y) { return std::clamp(y, 0L, gh - 1); };
+
+    parallel_for(0, zr.height, [&](std::size_t j0, std::size_t j1) {
+        for (std::size_t j = j0; j < j1; ++j) {
+            const Tap& v = ty[j];
+            const long y0 = clampy(v.i0), y1 = clampy(v.i0 + 1);
+
+            for (std::size_t i = 0; i < zr.width; ++i) {
+                const Tap& u = tx[i];
+                const long x0 = clampx(u.i0), x1 = clampx(u.i0 + 1);
+
+                // validité : cellule la plus proche
+                const long nx = u.f < 0.5 ? x0 : x1;
+                const long ny = v.f < 0.5 ? y0 : y1;
+                if (!g.mask[cell(nx, ny)]) continue;
+
+                const std::size_t id = j * zr.width + i;
+                zr.mask[id] = 1;
+
+                if (interp == Interp::Bicubic && u.i0 >= 1 && u.i0 + 2 < gw && v.i0 >= 1 && v.i0 + 2 < gh) {
+                    bool full = true;
+                    double rows[4];
+                    for (long k = 0; k < 4 && full; ++k) {
+                        const std::size_t base = cell(u.i0 - 1, v.i0 - 1 + k);
+                        for (long m = 0; m < 4; ++m) full = full && g.mask[base + m];
+                        const double* zz = g.z.data() + base;
+                        rows[k] = catmull_rom(zz[0], zz[1], zz[2], zz[3], u.f);
+                    }
+                    if (full) {
+                        zr.z[id] = catmull_rom(rows[0], rows[1], rows[2], rows[3], v.f);
+                        continue;
+                    }
+                }
+
+                const std::size_t c00 = cell(x0, y0), c10 = cell(x1, y0);
+                const std::size_t c01 = cell(x0, y1), c11 = cell(x1, y1);
+                const double w00 = g.mask[c00] ? (1.0 - u.f) * (1.0 - v.f) : 0.0;
+                const double w10 = g.mask[c10] ? u.f * (1.0 - v.f) : 0.0;
+                const double w01 = g.mask[c01] ? (1.0 - u.f) * v.f : 0.0;
+                const double w11 = g.mask[c11] ? u.f * v.f : 0.0;
+                const double ws = w00 + w10 + w01 + w11;
+
+                zr.z[id] = (ws > 0.0)
+                    ? (w00 * g.z[c00] + w10 * g.z[c10] + w01 * g.z[c01] + w11 * g.z[c11]) / ws
+                    : g.z[cell(nx, ny)];
+            }
+        }
+    }, 8);
+
+    return zr;
+}
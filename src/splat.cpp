@@ -0,0 +1,121 @@
+#include "splat.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include "binning.hpp"
+#include "delaunay.hpp"
+#include "grid.hpp"
+#include "mesh2D.hpp"
+#include "parallel.hpp"
+#include "profiler.hpp"
+#include "trianglelocator.hpp"
+
+bool PointSplatter::worthwhile(std::size_t point_count, std::size_t width, std::size_t height)
+{
+    if (width == 0 || height == 0) return false;
+    return (double)point_count >= AUTO_RATIO * (double)width * (double)height;
+}
+
+ZRaster PointSplatter::splat(const std::vector<Point3D>& pts, const BBox2D& bbox, std::size_t width, Stat stat, Info* info)
+{
+    MNT_PROFILE_ZONE("splat");
+    if (width == 0) throw std::runtime_error("PointSplatter: width == 0.");
+
+    ZRaster zr;
+    zr.width = width;
+    zr.height = Rasterizer::output_height(bbox, width);
+    zr.dx = (bbox.maxx - bbox.minx) / static_cast<double>(zr.width);
+    zr.dy = (bbox.maxy - bbox.miny) / static_cast<double>(zr.height);
+
+    const unsigned s = stat == Stat::Min ? PointBinner::MIN : stat == Stat::Max ? PointBinner::MAX : PointBinner::MEAN;
+    PointBinner::Result r = PointBinner::bin(pts, bbox, zr.width, zr.height, s);
+
+    zr.z = std::move(stat == Stat::Min ? r.min : stat == Stat::Max ? r.max : r.mean);
+    zr.mask.resize(zr.z.size());
+    std::size_t splatted = 0;
+    for (std::size_t id = 0; id < zr.mask.size(); ++id) {
+        zr.mask[id] = r.count[id] > 0;
+        splatted += zr.mask[id];
+    }
+
+    std::size_t ring = 0;
+    const std::size_t filled = fill_holes(zr, bbox, ring);
+
+    if (info) {
+        info->splatted = splatted;
+        info->ring_points = ring;
+        info->filled = filled;
+    }
+    return zr;
+}
+
+std::size_t PointSplatter::fill_holes(ZRaster& zr, const BBox2D& bbox, std::size_t& ring_points)
+{
+    MNT_PROFILE_ZONE("bouchage");
+    const std::size_t w = zr.width, h = zr.height;
+
+    // pixels remplis ayant un voisin (8-connexe) vide
+    std::vector<double> coords;
+    std::vector<double> alts;
+    for (std::size_t j = 0; j < h; ++j) {
+        for (std::size_t i = 0; i < w; ++i) {
+            const std::size_t id = j * w + i;
+            if (!zr.mask[id]) continue;
+
+            bool border = false;
+            for (long dj = -1; dj <= 1 && !border; ++dj) {
+                for (long di = -1; di <= 1 && !border; ++di) {
+                    const long ii = (long)i + di, jj = (long)j + dj;
+                    if (ii < 0 || jj < 0 || ii >= (long)w || jj >= (long)h) continue;
+                    border = !zr.mask[(std::size_t)jj * w + (std::size_t)ii];
+                }
+            }
+            if (!border) continue;
+
+            coords.push_back(bbox.minx + ((double)i + 0.5) * zr.dx);
+            coords.push_back(bbox.maxy - ((double)j + 0.5) * zr.dy);
+            alts.push_back(zr.z[id]);
+        }
+    }
+
+    ring_points = alts.size();
+    if (ring_points < 3) return 0;
+
+    std::vector<std::size_t> tris;
+    try {
+        tris = Delaunay::triangulate(coords);
+    } catch (const std::runtime_error&) {
+        return 0; // sommets alignés : rien à boucher
+    }
+
+    Mesh2D mesh(std::move(coords), std::move(tris), std::move(alts));
+
+    // index dimensionné sur le nombre de triangles (quelques-uns par cellule)
+    const double cells = std::max(1.0, (double)mesh.triangle_count() / 4.0);
+    const double aspect = (double)w / (double)h;
+    const std::size_t nx = std::clamp<std::size_t>((std::size_t)std::sqrt(cells * aspect), 1, w);
+    const std::size_t ny = std::clamp<std::size_t>((std::size_t)std::sqrt(cells / aspect), 1, h);
+    TriangleLocator locator(mesh, Grid(mesh, bbox, nx, ny));
+
+    std::atomic<std::size_t> filled{0};
+    parallel_for(0, h, [&](std::size_t j0, std::size_t j1) {
+        std::size_t local = 0;
+        for (std::size_t j = j0; j < j1; ++j) {
+            const double y = bbox.maxy - ((double)j + 0.5) * zr.dy;
+            for (std::size_t i = 0; i < w; ++i) {
+                const std::size_t id = j * w + i;
+                if (zr.mask[id]) continue;
+
+                const double x = bbox.minx + ((double)i + 0.5) * zr.dx;
+                const auto z = locator.interpolate(x, y);
+                if (!z) continue; // hors enveloppe -> noir
+                zr.z[id] = *z;
+                zr.mask[id] = 1;
+                ++local;
+            }
+        }
+        filled += local;
+    }, 8);
+    return filled;
+}
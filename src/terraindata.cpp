@@ -3,6 +3,7 @@
 #include <sstream>
 #include <stdexcept>
 #include "terraindata.hpp"
+#include "profiler.hpp"
 
 
 TerrainData::TerrainData(){
@@ -11,6 +12,7 @@ TerrainData::TerrainData(){
 
 void TerrainData::load_data_from_file(const std::string& filepath)
 {
+    MNT_PROFILE_ZONE("lecture");
     std::ifstream ifs(filepath);
     if (!ifs) {
         throw std::runtime_error("Impossible d'ouvrir le fichier MNT : " + filepath);
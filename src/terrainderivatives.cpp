@@ -0,0 +1,112 @@
+#include "terrainderivatives.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+TerrainDerivatives::Result TerrainDerivatives::compute(const std::vector<double>& z,
+                                                       const std::vector<std::uint8_t>& mask,
+                                                       std::size_t w, std::size_t h,
+                                                       double dx, double dy)
+{
+    MNT_PROFILE_ZONE("derivees");
+    Result r;
+    r.w = w;
+    r.h = h;
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    r.slope.assign(w * h, nan);
+    r.aspect.assign(w * h, nan);
+    r.plan_curv.assign(w * h, nan);
+    r.profile_curv.assign(w * h, nan);
+
+    if (w == 0 || h == 0) return r;
+
+    const double rad2deg = 180.0 / 3.14159265358979323846;
+    const double inv6dx = 1.0 / (6.0 * dx);
+    const double inv6dy = 1.0 / (6.0 * dy);
+    const double inv3dx2 = 1.0 / (3.0 * dx * dx);
+    const double inv3dy2 = 1.0 / (3.0 * dy * dy);
+    const double inv4dxdy = 1.0 / (4.0 * dx * dy);
+
+    parallel_for(0, h, [&](std::size_t y0, std::size_t y1) {
+        for (std::size_t y = y0; y < y1; ++y) {
+            // bords : réplication de la ligne / colonne voisine
+            const std::size_t yn = (y == 0) ? 0 : y - 1;
+            const std::size_t ys = (y + 1 == h) ? y : y + 1;
+
+            for (std::size_t x = 0; x < w; ++x) {
+                const std::size_t id = y * w + x;
+                if (!mask[id]) continue;
+
+                const std::size_t xw = (x == 0) ? 0 : x - 1;
+                const std::size_t xe = (x + 1 == w) ? x : x + 1;
+
+                const double z5 = z[id];
+                // voisin invalide -> valeur centrale
+                auto at = [&](std::size_t yy, std::size_t xx) -> double {
+                    const std::size_t k = yy * w + xx;
+                    return mask[k] ? z[k] : z5;
+                };
+
+                // z1 z2 z3   (nord)
+                // z4 z5 z6
+                // z7 z8 z9   (sud)
+                const double z1 = at(yn, xw), z2 = at(yn, x), z3 = at(yn, xe);
+                const double z4 = at(y,  xw),                 z6 = at(y,  xe);
+                const double z7 = at(ys, xw), z8 = at(ys, x), z9 = at(ys, xe);
+
+                // dérivées partielles (x vers l'est, y vers le nord)
+                const double p = (z3 + z6 + z9 - z1 - z4 - z7) * inv6dx;
+                const double q = (z1 + z2 + z3 - z7 - z8 - z9) * inv6dy;
+                const double rr = (z1 + z3 + z4 + z6 + z7 + z9 - 2.0 * (z2 + z5 + z8)) * inv3dx2;
+                const double t = (z1 + z2 + z3 + z7 + z8 + z9 - 2.0 * (z4 + z5 + z6)) * inv3dy2;
+                const double s = (z3 + z7 - z1 - z9) * inv4dxdy;
+
+                const double g2 = p * p + q * q;
+                r.slope[id] = static_cast<float>(std::atan(std::sqrt(g2)) * rad2deg);
+
+                if (g2 < 1e-18) {
+                    r.aspect[id] = -1.0f;
+                    r.plan_curv[id] = 0.0f;
+                    r.profile_curv[id] = 0.0f;
+                    continue;
+                }
+
+                // exposition = direction de la descente
+                double a = std::atan2(-p, -q) * rad2deg;
+                if (a < 0.0) a += 360.0;
+                r.aspect[id] = static_cast<float>(a);
+
+                const double num_prof = p * p * rr + 2.0 * p * q * s + q * q * t;
+                const double num_plan = q * q * rr - 2.0 * p * q * s + p * p * t;
+                r.profile_curv[id] = static_cast<float>(-num_prof / (g2 * std::pow(1.0 + g2, 1.5)));
+                r.plan_curv[id] = static_cast<float>(-num_plan / std::pow(g2, 1.5));
+            }
+        }
+    }, 16);
+
+    return r;
+}
+
+std::vector<std::uint8_t> TerrainDerivatives::colorize(const std::vector<float>& v, const HaxbyColorMap& cmap)
+{
+    double vmin = std::numeric_limits<double>::infinity();
+    double vmax = -std::numeric_limits<double>::infinity();
+    for (float f : v) {
+        if (!std::isfinite(f)) continue;
+        vmin = std::min(vmin, (double)f);
+        vmax = std::max(vmax, (double)f);
+    }
+
+    std::vector<std::uint8_t> img(v.size() * 3, 0);
+    for (std::size_t id = 0; id < v.size(); ++id) {
+        if (!std::isfinite(v[id])) continue; // invalide -> noir
+        const RGB c = cmap.color(v[id], vmin, vmax);
+        img[3 * id + 0] = c.r;
+        img[3 * id + 1] = c.g;
+        img[3 * id + 2] = c.b;
+    }
+    return img;
+}
@@ -0,0 +1,311 @@
+#include "terrainmosaic.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <glob.h>
+#include "parallel.hpp"
+#include "profiler.hpp"
+#include "threadpool.hpp"
+
+namespace {
+
+// Projecteurs réutilisés d'un fichier à l'autre : une copie de plus
+// seulement quand tous sont pris par des chargements en cours
+class ProjectorPool {
+public:
+    explicit ProjectorPool(const Projector& base) : m_base(base), m_free{&base} {}
+
+    const Projector* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty()) {
+                const Projector* q = m_free.back();
+                m_free.pop_back();
+                return q;
+            }
+        }
+        auto copy = std::make_unique<Projector>(m_base); // hors verrou : création PROJ coûteuse
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_owned.push_back(std::move(copy));
+        return m_owned.back().get();
+    }
+
+    void release(const Projector* q) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(q);
+    }
+
+private:
+    const Projector& m_base;
+    std::mutex m_mutex;
+    std::vector<const Projector*> m_free;
+    std::vector<std::unique_ptr<Projector>> m_owned;
+};
+
+// Cellule de la table de hachage spatiale (côté seam_tolerance)
+struct Cell {
+    std::int64_t x, y;
+    bool operator==(const Cell& o) const { return x == o.x && y == o.y; }
+};
+
+struct CellHash {
+    std::size_t operator()(const Cell& c) const {
+        return std::hash<std::uint64_t>()((std::uint64_t)c.x * 0x9E3779B97F4A7C15ull ^ (std::uint64_t)c.y);
+    }
+};
+
+bool intersect(const BBox2D& a, const BBox2D& b, BBox2D& out)
+{
+    out = {std::max(a.minx, b.minx), std::max(a.miny, b.miny), std::min(a.maxx, b.maxx), std::min(a.maxy, b.maxy)};
+    return out.minx <= out.maxx && out.miny <= out.maxy;
+}
+
+bool inside(const BBox2D& b, const Point3D& q)
+{
+    return q.x >= b.minx && q.x <= b.maxx && q.y >= b.miny && q.y <= b.maxy;
+}
+
+}
+
+std::vector<std::string> TerrainMosaic::expand(const std::string& spec, const std::string& dir)
+{
+    std::vector<std::string> paths;
+    std::size_t pos = 0;
+    while (pos <= spec.size()) {
+        const std::size_t comma = std::min(spec.find(',', pos), spec.size());
+        const std::string item = spec.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (item.empty()) continue;
+
+        const std::string path = dir.empty() ? item : dir + "/" + item;
+        if (item.find_first_of("*?[") == std::string::npos) {
+            paths.push_back(path);
+            continue;
+        }
+
+        glob_t g{};
+        const int rc = ::glob(path.c_str(), 0, nullptr, &g);
+        if (rc == 0) {
+            for (std::size_t i = 0; i < g.gl_pathc; ++i) paths.emplace_back(g.gl_pathv[i]);
+        }
+        ::globfree(&g);
+        if (rc != 0) throw std::runtime_error("TerrainMosaic: aucun fichier ne correspond à " + path + ".");
+    }
+
+    if (paths.empty()) throw std::runtime_error("TerrainMosaic: aucun fichier MNT.");
+    return paths;
+}
+
+TerrainMosaic::Result TerrainMosaic::load(const std::vector<std::string>& paths, const Projector& projector, const Params& p)
+{
+    MNT_PROFILE_ZONE("mosaique");
+    if (paths.empty()) throw std::runtime_error("TerrainMosaic: aucun fichier MNT.");
+
+    Result r;
+    r.files = paths.size();
+
+    // Fichier unique : chemin de TerrainStream, sans copie
+    if (paths.size() == 1) {
+        TerrainStream::Result in = TerrainStream::load(paths[0], projector, p.stream);
+        r.points = std::move(in.points);
+        r.bbox = in.bbox;
+        r.zmin = in.zmin;
+        r.zmax = in.zmax;
+        r.chunks = in.chunks;
+        return r;
+    }
+
+    // 1) Fichiers chargés en parallèle ; les blocs de chacun sont des tâches
+    // du même pool, un thread qui attend un fichier aide les autres
+    const std::size_t n = paths.size();
+    std::vector<TerrainStream::Result> tiles(n);
+    ProjectorPool projectors(projector);
+    {
+        TaskGroup group;
+        for (std::size_t f = 0; f < n; ++f) {
+            group.run([&, f] {
+                const Projector* proj = projectors.acquire();
+                struct Release {
+                    ProjectorPool& pool;
+                    const Projector* q;
+                    ~Release() { pool.release(q); }
+                } release{projectors, proj};
+
+                try {
+                    tiles[f] = TerrainStream::load(paths[f], *proj, p.stream);
+                } catch (const std::exception& e) {
+                    throw std::runtime_error(paths[f] + " : " + e.what());
+                }
+            });
+        }
+        group.wait();
+    }
+    for (const auto& t : tiles) r.chunks += t.chunks;
+
+    // 2) Raccords
+    std::vector<std::vector<char>> drop;
+    dedup_seams(tiles, p.seam_tolerance, drop, r);
+
+    // 3) Fusion dans l'ordre des fichiers ; emprise et altitudes recalculées
+    // seulement pour les tuiles qui ont perdu des points
+    std::vector<std::size_t> offset(n + 1, 0);
+    for (std::size_t f = 0; f < n; ++f) {
+        const std::size_t dropped = (std::size_t)std::count(drop[f].begin(), drop[f].end(), 1);
+        offset[f + 1] = offset[f] + tiles[f].points.size() - dropped;
+    }
+    r.points.resize(offset[n]);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<BBox2D> bbs(n, BBox2D{inf, inf, -inf, -inf});
+    std::vector<double> zmins(n, inf), zmaxs(n, -inf);
+
+    parallel_for(0, n, [&](std::size_t f0, std::size_t f1) {
+        for (std::size_t f = f0; f < f1; ++f) {
+            std::vector<Point3D>& src = tiles[f].points;
+            Point3D* dst = r.points.data() + offset[f];
+            if (drop[f].empty()) {
+                std::copy(src.begin(), src.end(), dst);
+                bbs[f] = tiles[f].bbox;
+                zmins[f] = tiles[f].zmin;
+                zmaxs[f] = tiles[f].zmax;
+            } else {
+                std::size_t k = 0;
+                for (std::size_t i = 0; i < src.size(); ++i) {
+                    if (drop[f][i]) continue;
+                    const Point3D& q = src[i];
+                    dst[k++] = q;
+                    bbs[f].minx = std::min(bbs[f].minx, q.x);
+                    bbs[f].miny = std::min(bbs[f].miny, q.y);
+                    bbs[f].maxx = std::max(bbs[f].maxx, q.x);
+                    bbs[f].maxy = std::max(bbs[f].maxy, q.y);
+                    zmins[f] = std::min(zmins[f], q.z);
+                    zmaxs[f] = std::max(zmaxs[f], q.z);
+                }
+            }
+            std::vector<Point3D>().swap(src); // libérée au fil de la fusion
+        }
+    });
+
+    r.bbox = {inf, inf, -inf, -inf};
+    r.zmin = inf;
+    r.zmax = -inf;
+    for (std::size_t f = 0; f < n; ++f) {
+        r.bbox.minx = std::min(r.bbox.minx, bbs[f].minx);
+        r.bbox.miny = std::min(r.bbox.miny, bbs[f].miny);
+        r.bbox.maxx = std::max(r.bbox.maxx, bbs[f].maxx);
+        r.bbox.maxy = std::max(r.bbox.maxy, bbs[f].maxy);
+        r.zmin = std::min(r.zmin, zmins[f]);
+        r.zmax = std::max(r.zmax, zmaxs[f]);
+    }
+    return r;
+}
+
+void TerrainMosaic::dedup_seams(const std::vector<TerrainStream::Result>& tiles, double tol, std::vector<std::vector<char>>& drop, Result& r)
+{
+    MNT_PROFILE_ZONE("mosaique_raccords");
+    const std::size_t n = tiles.size();
+    drop.assign(n, {});
+    if (!(tol > 0.0)) return;
+
+    // a) recouvrements deux à deux des emprises élargies de tol
+    auto grow = [tol](BBox2D b) {
+        b.minx -= tol;
+        b.miny -= tol;
+        b.maxx += tol;
+        b.maxy += tol;
+        return b;
+    };
+    std::vector<std::vector<BBox2D>> seams(n);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = a + 1; b < n; ++b) {
+            BBox2D s;
+            if (!intersect(grow(tiles[a].bbox), grow(tiles[b].bbox), s)) continue;
+            seams[a].push_back(s);
+            seams[b].push_back(s);
+        }
+    }
+
+    // b) points de chaque tuile situés dans un recouvrement
+    std::vector<std::vector<std::size_t>> cand(n);
+    parallel_for(0, n, [&](std::size_t f0, std::size_t f1) {
+        for (std::size_t f = f0; f < f1; ++f) {
+            if (seams[f].empty()) continue;
+            const auto& pts = tiles[f].points;
+            for (std::size_t i = 0; i < pts.size(); ++i) {
+                for (const auto& s : seams[f]) {
+                    if (inside(s, pts[i])) {
+                        cand[f].push_back(i);
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    // c) tuiles dans l'ordre : recherche parmi les points retenus des tuiles
+    // précédentes (table en lecture seule, en parallèle), puis insertion
+    const double inv = 1.0 / tol;
+    const double tol2 = tol * tol;
+    auto cell_of = [inv](double x, double y) {
+        return Cell{(std::int64_t)std::floor(x * inv), (std::int64_t)std::floor(y * inv)};
+    };
+    // cellule -> dernier point inséré, chaînage par next (pas d'allocation par cellule)
+    std::unordered_map<Cell, std::uint32_t, CellHash> table;
+    std::vector<Point2D> kept;
+    std::vector<std::uint32_t> next;
+    const std::uint32_t END = std::numeric_limits<std::uint32_t>::max();
+    std::size_t total = 0;
+    for (const auto& ids : cand) total += ids.size();
+    table.reserve(total);
+    kept.reserve(total);
+    next.reserve(total);
+
+    for (std::size_t f = 0; f < n; ++f) {
+        if (cand[f].empty()) continue;
+        const auto& pts = tiles[f].points;
+        const auto& ids = cand[f];
+        drop[f].assign(pts.size(), 0);
+        r.seam_points += ids.size();
+
+        if (!table.empty()) {
+            parallel_for(0, ids.size(), [&](std::size_t k0, std::size_t k1) {
+                for (std::size_t k = k0; k < k1; ++k) {
+                    const Point3D& q = pts[ids[k]];
+                    const Cell c = cell_of(q.x, q.y);
+                    for (std::int64_t dy = -1; dy <= 1 && !drop[f][ids[k]]; ++dy) {
+                        for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                            const auto it = table.find(Cell{c.x + dx, c.y + dy});
+                            if (it == table.end()) continue;
+                            std::uint32_t j = it->second;
+                            while (j != END) {
+                                const Point2D& o = kept[j];
+                                if ((o.x - q.x) * (o.x - q.x) + (o.y - q.y) * (o.y - q.y) <= tol2) break;
+                                j = next[j];
+                            }
+                            if (j != END) {
+                                drop[f][ids[k]] = 1;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }, 4096);
+        }
+
+        for (const std::size_t i : ids) {
+            if (drop[f][i]) {
+                ++r.duplicates;
+                continue;
+            }
+            const auto ins = table.emplace(cell_of(pts[i].x, pts[i].y), END);
+            next.push_back(ins.first->second);
+            ins.first->second = (std::uint32_t)kept.size();
+            kept.push_back({pts[i].x, pts[i].y});
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "terrainpipeline.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "delaunay.hpp"
+#include "grid.hpp"
+#include "memstats.hpp"
+#include "profiler.hpp"
+#include "projector.hpp"
+#include "terrainmosaic.hpp"
+#include "terrainstream.hpp"
+
+TerrainPipeline::TerrainPipeline(const std::string& filepath, const Params& p)
+{
+    Projector projector;
+    TerrainStream::Result in = TerrainStream::load(filepath, projector);
+    m_bbox = in.bbox;
+    m_zmin = in.zmin;
+    m_zmax = in.zmax;
+    build(in.points, p);
+}
+
+TerrainPipeline::TerrainPipeline(const std::vector<std::string>& paths, const Params& p)
+{
+    Projector projector;
+    TerrainMosaic::Result in = TerrainMosaic::load(paths, projector);
+    m_bbox = in.bbox;
+    m_zmin = in.zmin;
+    m_zmax = in.zmax;
+    build(in.points, p);
+}
+
+TerrainPipeline::TerrainPipeline(const std::vector<Point3D>& pts, const Params& p)
+{
+    m_bbox = bounds(pts, m_zmin, m_zmax);
+    build(pts, p);
+}
+
+TerrainPipeline::TerrainPipeline(const std::vector<Point3D>& pts, const BBox2D& bbox, double zmin, double zmax, const Params& p)
+    : m_bbox(bbox), m_zmin(zmin), m_zmax(zmax)
+{
+    build(pts, p);
+}
+
+BBox2D TerrainPipeline::bounds(const std::vector<Point3D>& pts, double& zmin, double& zmax)
+{
+    if (pts.empty()) throw std::runtime_error("TerrainPipeline: aucun point.");
+
+    const double inf = std::numeric_limits<double>::infinity();
+    BBox2D bb{inf, inf, -inf, -inf};
+    zmin = inf;
+    zmax = -inf;
+    for (const auto& q : pts) {
+        bb.minx = std::min(bb.minx, q.x);
+        bb.miny = std::min(bb.miny, q.y);
+        bb.maxx = std::max(bb.maxx, q.x);
+        bb.maxy = std::max(bb.maxy, q.y);
+        zmin = std::min(zmin, q.z);
+        zmax = std::max(zmax, q.z);
+    }
+    return bb;
+}
+
+void TerrainPipeline::build(const std::vector<Point3D>& pts, const Params& p)
+{
+    if (pts.size() < 3) throw std::runtime_error("TerrainPipeline: au moins 3 points requis.");
+
+    std::vector<double> coords;
+    std::vector<double> alts;
+    coords.reserve(pts.size() * 2);
+    alts.reserve(pts.size());
+    for (const auto& q : pts) {
+        coords.push_back(q.x);
+        coords.push_back(q.y);
+        alts.push_back(q.z);
+    }
+
+    std::vector<std::size_t> tris;
+    {
+        MemoryStats::Stage mem("Delaunay");
+        tris = Delaunay::triangulate(coords);
+    }
+    if (p.filter.enabled()) m_filter = TriangleFilter::cull(coords, tris, p.filter);
+
+    m_mesh = std::make_unique<Mesh2D>(std::move(coords), std::move(tris), std::move(alts));
+    if (p.tin_normals) m_mesh->compute_normals(p.smooth_normals);
+
+    {
+        MemoryStats::Stage mem("Index Grid");
+        m_locator = std::make_unique<TriangleLocator>(*m_mesh, Grid(*m_mesh, m_bbox, p.grid_nx, p.grid_ny, p.grid_overlap));
+    }
+    m_rasterizer = std::make_unique<Rasterizer>(*m_locator, m_bbox, m_zmin, m_zmax);
+}
+
+std::size_t TerrainPipeline::height(const BBox2D& view, std::size_t width)
+{
+    return Rasterizer::output_height(view, width);
+}
+
+std::size_t TerrainPipeline::rgb_size(const BBox2D& view, std::size_t width, Rasterizer::PixelFormat format)
+{
+    return width * height(view, width) * Rasterizer::channels(format);
+}
+
+void TerrainPipeline::render(const BBox2D& view, std::size_t width, const Rasterizer::Params& p, std::uint8_t* rgb, std::size_t capacity) const
+{
+    MNT_PROFILE_ZONE("pipeline_render");
+    if (p.ombrage && p.tin_shading && !m_mesh->has_normals())
+        throw std::runtime_error("TerrainPipeline: normales absentes (Params::tin_normals).");
+    if (!rgb || capacity < rgb_size(view, width, p.format))
+        throw std::runtime_error("TerrainPipeline: tampon de sortie trop petit.");
+
+    m_rasterizer->render_rgb(view, width, p, rgb);
+}
+
+std::vector<std::uint8_t> TerrainPipeline::render(std::size_t width, const Rasterizer::Params& p) const
+{
+    std::vector<std::uint8_t> img(rgb_size(m_bbox, width, p.format));
+    render(m_bbox, width, p, img.data(), img.size());
+    return img;
+}
+
+void TerrainPipeline::render_z(const BBox2D& view, std::size_t width, ZRaster& zr) const
+{
+    m_rasterizer->rasterize_z(view, width, zr);
+}
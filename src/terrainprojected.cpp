@@ -1,8 +1,10 @@
 #include "terrainprojected.hpp"
 #include <limits>
+#include "profiler.hpp"
 
 TerrainProjected::TerrainProjected(const TerrainData& terrain, const Projector& projector)
 {
+    MNT_PROFILE_ZONE("projection");
     m_min_x =  std::numeric_limits<double>::infinity();
     m_max_x = -std::numeric_limits<double>::infinity();
     m_min_y =  std::numeric_limits<double>::infinity();
@@ -0,0 +1,194 @@
+#include "terrainstream.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "parallel.hpp"
+#include "profiler.hpp"
+#include "threadpool.hpp"
+
+namespace {
+
+// Projection en lecture seule du fichier d'entrée
+struct MappedInput {
+    int fd = -1;
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+    explicit MappedInput(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Impossible d'ouvrir le fichier MNT : " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Impossible d'ouvrir le fichier MNT : " + path);
+        }
+        size = (std::size_t)st.st_size;
+        if (size == 0) return;
+
+        void* m = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Impossible de projeter le fichier MNT : " + path);
+        }
+        ::madvise(m, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(m);
+    }
+
+    ~MappedInput() {
+        if (data) ::munmap(const_cast<char*>(data), size);
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+// Début de la première ligne commençant à pos ou après
+std::size_t line_start(const char* data, std::size_t size, std::size_t pos)
+{
+    if (pos == 0) return 0;
+    if (pos >= size) return size;
+    if (data[pos - 1] == '\n') return pos;
+    const void* nl = std::memchr(data + pos, '\n', size - pos);
+    return nl ? (std::size_t)(static_cast<const char*>(nl) - data) + 1 : size;
+}
+
+}
+
+TerrainStream::Chunk TerrainStream::parse(const char* data, std::size_t size, std::size_t chunk_bytes, std::size_t index)
+{
+    MNT_PROFILE_ZONE("lecture_bloc");
+    Chunk c;
+    const std::size_t begin = line_start(data, size, index * chunk_bytes);
+    const std::size_t end = line_start(data, size, std::min(size, (index + 1) * chunk_bytes));
+    c.pts.reserve((end - begin) / 24 + 1);
+
+    // ligne copiée dans un tampon terminé par '\0' : strtod ne déborde ni
+    // sur la ligne suivante ni hors de la projection
+    std::string line;
+    std::size_t pos = begin;
+    while (pos < end) {
+        const void* nl = std::memchr(data + pos, '\n', end - pos);
+        const std::size_t eol = nl ? (std::size_t)(static_cast<const char*>(nl) - data) : end;
+        ++c.lines;
+
+        // Ignorer les lignes vides, format attendu : lat lon alt
+        if (eol > pos) {
+            line.assign(data + pos, eol - pos);
+            const char* s = line.c_str();
+            char* e = nullptr;
+            double v[3];
+            int k = 0;
+            for (; k < 3; ++k) {
+                v[k] = std::strtod(s, &e);
+                if (e == s) break;
+                s = e;
+            }
+            if (k < 3) {
+                c.bad_line = c.lines;
+                return c;
+            }
+            c.pts.emplace_back(v[0], v[1], v[2]);
+        }
+        pos = eol + 1;
+    }
+    return c;
+}
+
+TerrainStream::Result TerrainStream::load(const std::string& filepath, const Projector& projector, const Params& p)
+{
+    MNT_PROFILE_ZONE("lecture_flux");
+    const MappedInput in(filepath);
+    if (p.offset > in.size) throw std::runtime_error("Fichier MNT tronqué : " + filepath);
+    const char* data = in.data + p.offset;
+    const std::size_t size = in.size - p.offset;
+
+    Result r;
+    r.bytes = in.size;
+    const std::size_t chunk_bytes = std::max<std::size_t>(p.chunk_bytes, 4096);
+    const std::size_t nchunks = (size + chunk_bytes - 1) / chunk_bytes;
+    const std::size_t inflight = p.max_inflight ? p.max_inflight : 2 * worker_count();
+
+    const double inf = std::numeric_limits<double>::infinity();
+    r.bbox = {inf, inf, -inf, -inf};
+    r.zmin = inf;
+    r.zmax = -inf;
+    r.chunks = nchunks;
+
+    // Blocs analysés en attente de projection ; un seul "vidangeur" à la fois
+    std::mutex m;
+    std::vector<Chunk> ready(nchunks);
+    std::vector<char> done(nchunks, 0);
+    std::size_t next = 0;       // prochain bloc à projeter
+    std::size_t lines_before = p.first_line;
+    bool draining = false;
+
+    TaskGroup group;
+    std::function<void(std::size_t)> start;
+
+    // Projection dans l'ordre des blocs prêts, par le thread qui vient d'en terminer un
+    auto drain = [&] {
+        for (;;) {
+            Chunk c;
+            std::size_t idx;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (next >= nchunks || !done[next]) {
+                    draining = false;
+                    return;
+                }
+                idx = next++;
+                c = std::move(ready[idx]);
+            }
+
+            if (c.bad_line) {
+                throw std::runtime_error("Ligne " + std::to_string(lines_before + c.bad_line) + " mal formée dans le fichier MNT.");
+            }
+            lines_before += c.lines;
+
+            // le bloc suivant de la fenêtre peut partir dès maintenant
+            if (idx + inflight < nchunks) start(idx + inflight);
+
+            MNT_PROFILE_ZONE("projection_bloc");
+            if (idx == 0 && nchunks > 1) r.points.reserve(c.pts.size() * nchunks + c.pts.size() / 8);
+            for (const auto& g : c.pts) {
+                const Point2D q = projector.project(g.lon, g.lat);
+                r.points.push_back({q.x, q.y, g.alt});
+                r.bbox.minx = std::min(r.bbox.minx, q.x);
+                r.bbox.miny = std::min(r.bbox.miny, q.y);
+                r.bbox.maxx = std::max(r.bbox.maxx, q.x);
+                r.bbox.maxy = std::max(r.bbox.maxy, q.y);
+                r.zmin = std::min(r.zmin, g.alt);
+                r.zmax = std::max(r.zmax, g.alt);
+            }
+        }
+    };
+
+    start = [&](std::size_t idx) {
+        group.run([&, idx] {
+            Chunk c = parse(data, size, chunk_bytes, idx);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                ready[idx] = std::move(c);
+                done[idx] = 1;
+                if (draining) return;
+                draining = true;
+            }
+            drain();
+        });
+    };
+
+    for (std::size_t i = 0; i < std::min(inflight, nchunks); ++i) start(i);
+    group.wait();
+    r.lines = lines_before;
+
+    if (r.points.empty() && p.offset == 0) {
+        throw std::runtime_error("Fichier MNT vide ou sans données valides : " + filepath);
+    }
+    return r;
+}
@@ -0,0 +1,162 @@
+#include "threadpool.hpp"
+#include "parallel.hpp"
+
+namespace {
+// Pool et file du worker courant (nullptr hors pool)
+thread_local ThreadPool* t_pool = nullptr;
+thread_local std::size_t t_index = 0;
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool(worker_count() - 1);
+    return pool;
+}
+
+ThreadPool::ThreadPool(std::size_t workers)
+{
+    m_queues.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) m_queues.push_back(std::make_unique<Queue>());
+
+    m_threads.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        m_threads.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_threads) t.join();
+}
+
+void ThreadPool::submit(Task t)
+{
+    Queue& q = (t_pool == this) ? *m_queues[t_index] : m_inject;
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        q.tasks.push_back(std::move(t));
+    }
+    {
+        // incrément sous m_mutex : pas de réveil perdu dans wait_for_work
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queued;
+    }
+    m_cv.notify_one();
+}
+
+bool ThreadPool::pop_front(Queue& q, Task& t)
+{
+    std::lock_guard<std::mutex> lock(q.m);
+    if (q.tasks.empty()) return false;
+    t = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::pop_local(std::size_t index, Task& t)
+{
+    Queue& q = *m_queues[index];
+    std::lock_guard<std::mutex> lock(q.m);
+    if (q.tasks.empty()) return false;
+    t = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::run_one()
+{
+    if (m_queued.load(std::memory_order_acquire) == 0) return false;
+
+    Task t;
+    bool found = (t_pool == this) && pop_local(t_index, t);
+    if (!found) found = pop_front(m_inject, t);
+
+    // vol : parcours des autres files depuis une position tournante
+    const std::size_t n = m_queues.size();
+    const std::size_t start = n ? m_steal_seed.fetch_add(1, std::memory_order_relaxed) % n : 0;
+    for (std::size_t k = 0; !found && k < n; ++k) {
+        const std::size_t v = (start + k) % n;
+        if (t_pool == this && v == t_index) continue;
+        found = pop_front(*m_queues[v], t);
+    }
+    if (!found) return false;
+
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+    t();
+    return true;
+}
+
+void ThreadPool::wait_for_work(const std::function<bool()>& done)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&] { return m_stop || m_queued.load() > 0 || done(); });
+}
+
+void ThreadPool::notify_all()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_cv.notify_all();
+}
+
+void ThreadPool::worker_loop(std::size_t index)
+{
+    t_pool = this;
+    t_index = index;
+
+    for (;;) {
+        if (run_one()) continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0) return;
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+TaskGroup::~TaskGroup()
+{
+    // déroulement sur exception : attendre quand même les tâches en cours
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> fn)
+{
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    // le groupe peut être détruit dès m_pending à 0 : le pool est capturé à part
+    ThreadPool* pool = &m_pool;
+    m_pool.submit([this, pool, fn = std::move(fn)] {
+        try {
+            fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_error_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) pool->notify_all();
+    });
+}
+
+void TaskGroup::wait()
+{
+    while (m_pending.load(std::memory_order_acquire) > 0) {
+        if (m_pool.run_one()) continue;
+        m_pool.wait_for_work([this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::exception_ptr e;
+    {
+        std::lock_guard<std::mutex> lock(m_error_mutex);
+        std::swap(e, m_error);
+    }
+    if (e) std::rethrow_exception(e);
+}
@@ -0,0 +1,93 @@
+#include "trianglefilter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+// Carrés des longueurs des trois arêtes du triangle (tri : ses trois sommets)
+void edges2(const std::vector<double>& coords, const std::size_t* tri, double e[3])
+{
+    for (int k = 0; k < 3; ++k) {
+        const std::size_t a = tri[k], b = tri[(k + 1) % 3];
+        const double dx = coords[2 * b] - coords[2 * a];
+        const double dy = coords[2 * b + 1] - coords[2 * a + 1];
+        e[k] = dx * dx + dy * dy;
+    }
+}
+
+}
+
+double TriangleFilter::median_edge(const std::vector<double>& coords, const std::vector<std::size_t>& triangles)
+{
+    // échantillon régulier d'au plus ~32k triangles : médiane stable, coût négligeable
+    const std::size_t nt = triangles.size() / 3;
+    const std::size_t step = std::max<std::size_t>(1, nt / 32768);
+    std::vector<double> len;
+    len.reserve(3 * (nt / step + 1));
+    for (std::size_t t = 0; t < nt; t += step) {
+        double e[3];
+        edges2(coords, triangles.data() + 3 * t, e);
+        len.insert(len.end(), e, e + 3);
+    }
+    if (len.empty()) return 0.0;
+
+    const auto mid = len.begin() + (std::ptrdiff_t)(len.size() / 2);
+    std::nth_element(len.begin(), mid, len.end());
+    return std::sqrt(*mid);
+}
+
+TriangleFilter::Stats TriangleFilter::cull(const std::vector<double>& coords, std::vector<std::size_t>& triangles, const Params& p)
+{
+    MNT_PROFILE_ZONE("filtrage_triangles");
+    Stats s;
+    const std::size_t nt = triangles.size() / 3;
+
+    double max_edge = p.max_edge > 0.0 ? p.max_edge : 0.0;
+    if (p.edge_factor > 0.0) {
+        const double rel = p.edge_factor * median_edge(coords, triangles);
+        max_edge = max_edge > 0.0 ? std::min(max_edge, rel) : rel;
+    }
+    s.max_edge = max_edge;
+    const double edge2 = max_edge * max_edge;
+    const double alpha = p.alpha;
+
+    // 0 : conservé, 1 : arête trop longue, 2 : hors forme alpha
+    std::vector<unsigned char> why(nt, 0);
+    parallel_for(0, nt, [&](std::size_t t0, std::size_t t1) {
+        for (std::size_t t = t0; t < t1; ++t) {
+            const std::size_t* tri = triangles.data() + 3 * t;
+            double e[3];
+            edges2(coords, tri, e);
+            if (edge2 > 0.0 && std::max({e[0], e[1], e[2]}) > edge2) {
+                why[t] = 1;
+                continue;
+            }
+            if (alpha > 0.0) {
+                // R = abc / (4 aire) ; triangle plat : rayon infini
+                const std::size_t a = tri[0], b = tri[1], c = tri[2];
+                const double cross = (coords[2 * b] - coords[2 * a]) * (coords[2 * c + 1] - coords[2 * a + 1])
+                                   - (coords[2 * b + 1] - coords[2 * a + 1]) * (coords[2 * c] - coords[2 * a]);
+                // R > alpha  <=>  e0 e1 e2 > (2 alpha |cross|)^2
+                const double lim = 2.0 * alpha * std::fabs(cross);
+                if (e[0] * e[1] * e[2] > lim * lim) why[t] = 2;
+            }
+        }
+    }, 4096);
+
+    // compactage en place, ordre des triangles conservé
+    std::size_t k = 0;
+    for (std::size_t t = 0; t < nt; ++t) {
+        if (why[t] == 1) { ++s.long_edge; continue; }
+        if (why[t] == 2) { ++s.alpha; continue; }
+        if (k != t) std::copy_n(triangles.begin() + (std::ptrdiff_t)(3 * t), 3, triangles.begin() + (std::ptrdiff_t)(3 * k));
+        ++k;
+    }
+    triangles.resize(3 * k);
+    s.kept = k;
+
+    if (k == 0) throw std::runtime_error("TriangleFilter: tous les triangles sont écartés (seuil trop faible).");
+    return s;
+}
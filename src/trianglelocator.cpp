@@ -1,19 +1,25 @@
 #include "trianglelocator.hpp"
+#include "profiler.hpp"
 
 TriangleLocator::TriangleLocator(const Mesh2D& mesh, Grid index): m_mesh(mesh), m_index(std::move(index)){}
 
 std::optional<TriHit> TriangleLocator::locate(double x, double y) const {
     const Vec2 p{x, y};
     const auto& cand = m_index.candidates(x, y);
+    MNT_PROFILE_COUNT(LocateCalls, 1);
 
-    for (std::size_t ti : cand) {
+    for (std::size_t k = 0; k < cand.size(); ++k) {
+        const std::size_t ti = cand[k];
         if (!m_mesh.point_in_triangle(ti, p)) continue;
 
         double a, b, c;
         if (!m_mesh.barycentric(ti, p, a, b, c)) continue;
 
+        MNT_PROFILE_COUNT(LocateCandidates, k + 1);
         return TriHit{ti, a, b, c};
     }
+    MNT_PROFILE_COUNT(LocateCandidates, cand.size());
+    MNT_PROFILE_COUNT(LocateMisses, 1);
     return std::nullopt;
 }
 
@@ -24,3 +30,15 @@ std::optional<double> TriangleLocator::interpolate(double x, double y) const {
     }
     return m_mesh.interpolate_z(hit->triangle_id, hit->a, hit->b, hit->c);
 }
+
+const Mesh2D& TriangleLocator::mesh() const {
+    return m_mesh;
+}
+
+const Grid& TriangleLocator::index() const {
+    return m_index;
+}
+
+Grid& TriangleLocator::index() {
+    return m_index;
+}
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "binning.hpp"
+#include "delaunay.hpp"
+#include "fft.hpp"
+#include "grid.hpp"
+#include "incrementaltin.hpp"
+#include "mesh2D.hpp"
+#include "png.hpp"
+#include "ppm.hpp"
+#include "rasterise.hpp"
+#include "trianglelocator.hpp"
+
+// Tests de non-régression (ctest) : un cas par appel, test_mnt <cas>, code
+// de sortie non nul et message sur stderr en cas d'échec. Données générées
+// à graine fixe, fichiers dans le répertoire temporaire.
+
+static void check(bool ok, const std::string& what)
+{
+    if (!ok) throw std::runtime_error(what);
+}
+
+static std::filesystem::path scratch()
+{
+    const auto dir = std::filesystem::temp_directory_path() / "test_mnt";
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+static std::vector<std::uint8_t> read_file(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    check((bool)ifs, "fichier illisible : " + path);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(ifs), {});
+}
+
+// Points uniformes dans [0, w] x [0, h], relief lisse (pas de points cocycliques)
+static std::vector<Point3D> random_points(std::size_t n, double w, double h, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> ux(0.0, w), uy(0.0, h);
+    std::vector<Point3D> pts(n);
+    for (auto& p : pts) {
+        p.x = ux(rng);
+        p.y = uy(rng);
+        p.z = 40.0 * std::sin(p.x / 97.0) * std::cos(p.y / 61.0) + 0.02 * p.x;
+    }
+    return pts;
+}
+
+// ---------------------------------------------------------------------------
+
+// FFT réelle : inverse(forward(x)) == x, composante continue = somme
+static void test_fft()
+{
+    const std::size_t sizes[][2] = {{64, 32}, {8, 128}, {256, 256}};
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+
+    for (const auto& s : sizes) {
+        const std::size_t w = s[0], h = s[1];
+        std::vector<double> in(w * h), out;
+        for (auto& v : in) v = u(rng);
+
+        const FFT2D fft(w, h);
+        std::vector<FFT2D::cplx> spec;
+        fft.forward(in, spec);
+        check(spec.size() == fft.spec_width() * h, "taille du spectre");
+
+        double sum = 0.0;
+        for (double v : in) sum += v;
+        check(std::abs(spec[0] - FFT2D::cplx(sum, 0.0)) < 1e-9, "composante continue");
+
+        fft.inverse(spec, out);
+        check(out.size() == in.size(), "taille de la sortie inverse");
+        double err = 0.0;
+        for (std::size_t i = 0; i < in.size(); ++i) err = std::max(err, std::fabs(out[i] - in[i]));
+        check(err < 1e-12, "aller-retour FFT " + std::to_string(w) + "x" + std::to_string(h) + " : ecart " + std::to_string(err));
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+// Décodage PNG minimal (RGB 8 bits, non entrelacé) : CRC des chunks, zlib, filtres
+static std::vector<std::uint8_t> decode_png(const std::string& path, std::size_t& w, std::size_t& h)
+{
+    const std::vector<std::uint8_t> f = read_file(path);
+    static const std::uint8_t SIG[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    check(f.size() > 8 && std::equal(SIG, SIG + 8, f.begin()), "signature PNG");
+
+    auto be32 = [&](std::size_t at) {
+        return (std::uint32_t)f[at] << 24 | (std::uint32_t)f[at + 1] << 16 | (std::uint32_t)f[at + 2] << 8 | f[at + 3];
+    };
+
+    std::vector<std::uint8_t> idat;
+    bool ihdr = false, iend = false;
+    for (std::size_t at = 8; at < f.size() && !iend;) {
+        check(at + 12 <= f.size(), "chunk tronque");
+        const std::size_t len = be32(at);
+        check(at + 12 + len <= f.size(), "chunk tronque");
+        const std::string type(f.begin() + (std::ptrdiff_t)(at + 4), f.begin() + (std::ptrdiff_t)(at + 8));
+        const std::uint8_t* data = f.data() + at + 8;
+        const uLong crc = crc32(crc32(0L, Z_NULL, 0), f.data() + at + 4, (uInt)(len + 4));
+        check(crc == be32(at + 8 + len), "CRC du chunk " + type);
+
+        if (type == "IHDR") {
+            w = be32(at + 8);
+            h = be32(at + 12);
+            check(data[8] == 8 && data[9] == 2 && data[12] == 0, "IHDR : RGB 8 bits non entrelace attendu");
+            ihdr = true;
+        } else if (type == "IDAT") {
+            idat.insert(idat.end(), data, data + len);
+        } else if (type == "IEND") {
+            iend = true;
+        }
+        at += 12 + len;
+    }
+    check(ihdr && iend, "IHDR ou IEND absent");
+
+    const std::size_t stride = 3 * w;
+    std::vector<std::uint8_t> raw(h * (stride + 1));
+    uLongf raw_len = (uLongf)raw.size();
+    check(uncompress(raw.data(), &raw_len, idat.data(), (uLong)idat.size()) == Z_OK, "flux zlib invalide");
+    check(raw_len == raw.size(), "taille des donnees decompressees");
+
+    std::vector<std::uint8_t> rgb(h * stride);
+    for (std::size_t y = 0; y < h; ++y) {
+        const std::uint8_t type = raw[y * (stride + 1)];
+        const std::uint8_t* in = raw.data() + y * (stride + 1) + 1;
+        std::uint8_t* cur = rgb.data() + y * stride;
+        const std::uint8_t* prev = y ? cur - stride : nullptr;
+        for (std::size_t i = 0; i < stride; ++i) {
+            const int a = i >= 3 ? cur[i - 3] : 0;
+            const int b = prev ? prev[i] : 0;
+            const int c = (prev && i >= 3) ? prev[i - 3] : 0;
+            int pred = 0;
+            switch (type) {
+            case 0: pred = 0; break;
+            case 1: pred = a; break;
+            case 2: pred = b; break;
+            case 3: pred = (a + b) / 2; break;
+            case 4: {
+                const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                break;
+            }
+            default: check(false, "filtre PNG inconnu " + std::to_string(type));
+            }
+            cur[i] = (std::uint8_t)(in[i] + pred);
+        }
+    }
+    return rgb;
+}
+
+static std::vector<std::uint8_t> read_p6(const std::string& path, std::size_t& w, std::size_t& h)
+{
+    const std::vector<std::uint8_t> f = read_file(path);
+    std::istringstream hdr(std::string(f.begin(), f.begin() + (std::ptrdiff_t)std::min<std::size_t>(f.size(), 64)));
+    std::string magic;
+    int maxv = 0;
+    hdr >> magic >> w >> h >> maxv;
+    check(magic == "P6" && maxv == 255, "en-tete P6");
+    const std::size_t off = (std::size_t)hdr.tellg() + 1;
+    check(f.size() == off + 3 * w * h, "taille du fichier P6");
+    return std::vector<std::uint8_t>(f.begin() + (std::ptrdiff_t)off, f.end());
+}
+
+// PNG (image complète et écriture par bandes) décodé == pixels du P6
+static void test_png()
+{
+    // largeur impaire, plusieurs blocs compressés ; bruit et dégradés alternés
+    const std::size_t w = 517, h = 400;
+    std::vector<std::uint8_t> rgb(w * h * 3);
+    std::mt19937 rng(7);
+    for (std::size_t y = 0; y < h; ++y) {
+        for (std::size_t x = 0; x < w; ++x) {
+            std::uint8_t* p = rgb.data() + 3 * (y * w + x);
+            if ((y / 50) % 2) {
+                p[0] = (std::uint8_t)rng(); p[1] = (std::uint8_t)rng(); p[2] = (std::uint8_t)rng();
+            } else {
+                p[0] = (std::uint8_t)x; p[1] = (std::uint8_t)(x + y); p[2] = (std::uint8_t)(3 * y);
+            }
+        }
+    }
+
+    const std::string ppm = (scratch() / "image.ppm").string();
+    const std::string png = (scratch() / "image.png").string();
+    const std::string bands = (scratch() / "bandes.png").string();
+    PPM::write_p6(ppm, w, h, rgb);
+    PngWriter::write(png, w, h, rgb);
+    {
+        PngWriter pw(bands, w, h);
+        for (std::size_t y = 0; y < h; y += 37) pw.write_rows(rgb.data() + 3 * y * w, std::min<std::size_t>(37, h - y));
+        pw.finish();
+    }
+
+    std::size_t pw = 0, ph = 0;
+    const std::vector<std::uint8_t> ref = read_p6(ppm, pw, ph);
+    check(pw == w && ph == h && ref == rgb, "relecture P6");
+    for (const std::string& path : {png, bands}) {
+        std::size_t dw = 0, dh = 0;
+        const std::vector<std::uint8_t> dec = decode_png(path, dw, dh);
+        check(dw == w && dh == h, "dimensions PNG");
+        check(dec == ref, "pixels PNG differents du P6 : " + path);
+        std::filesystem::remove(path);
+    }
+    std::filesystem::remove(ppm);
+}
+
+// ---------------------------------------------------------------------------
+
+// Maillage complété par insertions (avec relecture d'état) == rendu complet
+static void test_incremental()
+{
+    const std::vector<Point3D> pts = random_points(20000, 1200.0, 800.0, 3);
+    BBox2D bb{1e300, 1e300, -1e300, -1e300};
+    double zmin = 1e300, zmax = -1e300;
+    for (const auto& p : pts) {
+        bb.minx = std::min(bb.minx, p.x); bb.maxx = std::max(bb.maxx, p.x);
+        bb.miny = std::min(bb.miny, p.y); bb.maxy = std::max(bb.maxy, p.y);
+        zmin = std::min(zmin, p.z); zmax = std::max(zmax, p.z);
+    }
+    const std::size_t width = 400;
+    const std::size_t head = 17000;
+
+    const IncrementalTin full(pts, bb, zmin, zmax, width);
+
+    const std::string state = (scratch() / "etat").string();
+    {
+        const std::vector<Point3D> first(pts.begin(), pts.begin() + (std::ptrdiff_t)head);
+        IncrementalTin(first, bb, zmin, zmax, width).save(state);
+    }
+    std::unique_ptr<IncrementalTin> tin = IncrementalTin::load(state);
+    std::filesystem::remove(state);
+    check(tin != nullptr, "etat non relu");
+
+    Rasterizer::Params rp;
+    const Rasterizer rast(bb, zmin, zmax);
+    const std::vector<std::uint8_t> before = rast.colorize(tin->raster(), rp);
+
+    IncrementalTin::Stats st;
+    const std::vector<Point3D> tail(pts.begin() + (std::ptrdiff_t)head, pts.end());
+    check(tin->insert(tail, st), "insertion degeneree");
+    check(st.inserted == tail.size(), "points non inseres");
+    const IncrementalTin::PixelRect r = tin->update_raster();
+
+    check(tin->mesh().triangle_count() == full.mesh().triangle_count(), "nombre de triangles");
+    check(tin->raster().mask == full.raster().mask, "masque de la grille z");
+
+    const std::vector<std::uint8_t> img = rast.colorize(tin->raster(), rp);
+    check(img == rast.colorize(full.raster(), rp), "image differente du rendu complet");
+
+    // pixels modifiés : dans le rectangle, marge d'ombrage d'un pixel comprise
+    const std::size_t w = tin->raster().width, h = tin->raster().height;
+    for (std::size_t y = 0; y < h; ++y) {
+        for (std::size_t x = 0; x < w; ++x) {
+            const std::size_t i = 3 * (y * w + x);
+            if (std::equal(img.begin() + (std::ptrdiff_t)i, img.begin() + (std::ptrdiff_t)i + 3, before.begin() + (std::ptrdiff_t)i)) continue;
+            check(x + 1 >= r.x0 && x <= r.x1 && y + 1 >= r.y0 && y <= r.y1, "pixel modifie hors du rectangle");
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+// PointBinner : résultat identique d'un appel à l'autre, égal à une boucle séquentielle
+static void test_binning()
+{
+    std::vector<Point3D> pts = random_points(300000, 1000.0, 500.0, 5);
+    // quelques points hors grille et des doublons d'altitude pour la médiane
+    for (std::size_t i = 0; i < pts.size(); i += 997) pts[i].x = -1.0;
+    for (std::size_t i = 1; i < pts.size(); i += 13) pts[i].z = std::round(pts[i].z);
+    const BBox2D bb{0.0, 0.0, 1000.0, 500.0};
+
+    const std::size_t grids[][2] = {{40, 20}, {1500, 900}};
+    for (const auto& g : grids) {
+        const std::size_t gw = g[0], gh = g[1];
+        const unsigned stats = PointBinner::MEAN | PointBinner::MIN | PointBinner::MAX | (gw > 100 ? PointBinner::MEDIAN : 0u);
+        const PointBinner::Result a = PointBinner::bin(pts, bb, gw, gh, stats);
+        const PointBinner::Result b = PointBinner::bin(pts, bb, gw, gh, stats);
+        check(a.count == b.count && a.mean == b.mean && a.min == b.min && a.max == b.max && a.median == b.median,
+              "resultats differents entre deux appels (" + std::to_string(gw) + "x" + std::to_string(gh) + ")");
+
+        // référence séquentielle (même convention de cellule : ligne 0 = maxy)
+        std::vector<std::vector<double>> cells(gw * gh);
+        for (const auto& p : pts) {
+            const double tx = (p.x - bb.minx) / (bb.maxx - bb.minx);
+            const double ty = (bb.maxy - p.y) / (bb.maxy - bb.miny);
+            if (!(tx >= 0.0 && tx < 1.0 && ty >= 0.0 && ty < 1.0)) continue;
+            const std::size_t ix = std::min<std::size_t>(gw - 1, (std::size_t)(tx * (double)gw));
+            const std::size_t iy = std::min<std::size_t>(gh - 1, (std::size_t)(ty * (double)gh));
+            cells[iy * gw + ix].push_back(p.z);
+        }
+        for (std::size_t c = 0; c < cells.size(); ++c) {
+            std::vector<double>& v = cells[c];
+            check(a.count[c] == v.size(), "compte de la cellule " + std::to_string(c));
+            if (v.empty()) continue;
+            double sum = 0.0;
+            for (double z : v) sum += z;
+            check(std::fabs(a.mean[c] - sum / (double)v.size()) <= 1e-9 * (1.0 + std::fabs(a.mean[c])), "moyenne de la cellule " + std::to_string(c));
+            check(a.min[c] == *std::min_element(v.begin(), v.end()), "minimum de la cellule " + std::to_string(c));
+            check(a.max[c] == *std::max_element(v.begin(), v.end()), "maximum de la cellule " + std::to_string(c));
+            if (stats & PointBinner::MEDIAN) {
+                std::sort(v.begin(), v.end());
+                const std::size_t n = v.size();
+                const double med = (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+                check(a.median[c] == med, "mediane de la cellule " + std::to_string(c));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+// Grid::Overlap::Exact trouve tout triangle trouvé avec Overlap::BBox
+static void test_grid_overlap()
+{
+    // levé uniforme puis levé en bandes espacées (triangles longs et obliques entre bandes)
+    std::vector<Point3D> banded = random_points(12000, 1500.0, 1500.0, 11);
+    for (auto& p : banded) p.y = std::floor(p.y / 150.0) * 150.0 + std::fmod(p.y, 20.0) + 0.3 * p.x;
+    const std::vector<std::vector<Point3D>> sets = {random_points(15000, 1000.0, 700.0, 9), banded};
+
+    for (const auto& pts : sets) {
+        std::vector<double> coords, alts;
+        BBox2D bb{1e300, 1e300, -1e300, -1e300};
+        for (const auto& p : pts) {
+            coords.push_back(p.x);
+            coords.push_back(p.y);
+            alts.push_back(p.z);
+            bb.minx = std::min(bb.minx, p.x); bb.maxx = std::max(bb.maxx, p.x);
+            bb.miny = std::min(bb.miny, p.y); bb.maxy = std::max(bb.maxy, p.y);
+        }
+        std::vector<std::size_t> tris = Delaunay::triangulate(coords);
+        const Mesh2D mesh(coords, std::move(tris), alts);
+
+        // emprise de l'index : celle des points, ou réduite (triangles débordant
+        // de la grille, rangées extrêmes écrêtées)
+        const double mx = 0.15 * (bb.maxx - bb.minx), my = 0.15 * (bb.maxy - bb.miny);
+        const BBox2D inner{bb.minx + mx, bb.miny + my, bb.maxx - mx, bb.maxy - my};
+        const struct { BBox2D box; std::size_t nx, ny; } configs[] = {{bb, 200, 140}, {bb, 37, 23}, {inner, 60, 45}};
+        for (const auto& g : configs) {
+            const TriangleLocator by_bbox(mesh, Grid(mesh, g.box, g.nx, g.ny, Grid::Overlap::BBox));
+            const TriangleLocator exact(mesh, Grid(mesh, g.box, g.nx, g.ny, Grid::Overlap::Exact));
+
+            std::mt19937_64 rng(13);
+            std::uniform_real_distribution<double> ux(bb.minx, bb.maxx), uy(bb.miny, bb.maxy);
+            std::vector<std::pair<double, double>> queries;
+            for (std::size_t i = 0; i < 200000; ++i) queries.emplace_back(ux(rng), uy(rng));
+            // sommets et milieux d'arêtes : points sur les bords de cellules et de triangles
+            for (std::size_t v = 0; v < mesh.vertex_count(); v += 7) queries.emplace_back(coords[2 * v], coords[2 * v + 1]);
+            const auto& T = mesh.triangles();
+            for (std::size_t t = 0; t < mesh.triangle_count(); t += 5) {
+                const Vec2 a = mesh.vertex(T[3 * t]), b = mesh.vertex(T[3 * t + 1]);
+                queries.emplace_back(0.5 * (a.x + b.x), 0.5 * (a.y + b.y));
+            }
+
+            std::size_t hits = 0;
+            for (const auto& q : queries) {
+                const std::optional<double> zb = by_bbox.interpolate(q.first, q.second);
+                if (!zb) continue;
+                ++hits;
+                const std::optional<double> ze = exact.interpolate(q.first, q.second);
+                check((bool)ze, "point trouve par l'index bbox mais pas par l'index exact");
+                check(std::fabs(*ze - *zb) <= 1e-9 * (1.0 + std::fabs(*zb)), "interpolation differente entre les deux index");
+            }
+            check(hits > queries.size() / 2, "trop peu de requetes dans le maillage");
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    const std::vector<std::pair<std::string, std::function<void()>>> cases = {
+        {"fft", test_fft},
+        {"png", test_png},
+        {"incremental", test_incremental},
+        {"binning", test_binning},
+        {"grid_overlap", test_grid_overlap},
+    };
+
+    const std::string only = argc > 1 ? argv[1] : "";
+    bool found = false;
+    int failed = 0;
+    for (const auto& c : cases) {
+        if (!only.empty() && c.first != only) continue;
+        found = true;
+        try {
+            c.second();
+            std::cout << "OK     " << c.first << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "ECHEC  " << c.first << " : " << e.what() << "\n";
+            ++failed;
+        }
+    }
+    if (!found) {
+        std::cerr << "Utilisation : " << argv[0] << " [fft|png|incremental|binning|grid_overlap]\n";
+        return EXIT_FAILURE;
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}